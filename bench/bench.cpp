@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <random>
+#include "lexer.hpp"
+#include "incremental_lexer.hpp"
+#include "simd.hpp"
+#include "corpus.hpp"
+
+/*every heap allocation in the process goes through here so a benchmark can report allocations per token*/
+static std::atomic<size_t> allocation_count(0);
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+struct BENCH_OPTIONS {
+    CORPUS_OPTIONS corpus;
+    const char* input = nullptr;    // lex this file instead of a generated corpus
+    const char* emit = nullptr;     // write the generated corpus here and exit
+    int warmup = 1;
+    int reps = 5;
+    int edits = 1000;   // keystrokes per IncrementalLexer repetition
+};
+
+struct RESULT {
+    const char* name;
+    size_t bytes;
+    size_t items;
+    double allocations;     // per repetition
+    std::vector<double> seconds;
+};
+
+/*runs body warmup + reps times; body returns how many tokens (or inserts) it produced*/
+template <typename BODY>
+static RESULT measure(const char* name, size_t bytes, const BENCH_OPTIONS& options, BODY body) {
+    RESULT result{name, bytes, 0, 0, {}};
+    for (int i = 0; i < options.warmup; ++i) {
+        body();
+    }
+    size_t allocations = 0;
+    for (int i = 0; i < options.reps; ++i) {
+        size_t before = allocation_count.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        result.items = body();
+        auto stop = std::chrono::steady_clock::now();
+        allocations += allocation_count.load(std::memory_order_relaxed) - before;
+        result.seconds.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    result.allocations = options.reps ? double(allocations) / options.reps : 0;
+    return result;
+}
+
+static void report(const RESULT& result) {
+    std::vector<double> sorted = result.seconds;
+    std::sort(sorted.begin(), sorted.end());
+    double best = sorted.empty() ? 0 : sorted.front();
+    double median = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+    double mb = result.bytes / double(1 << 20);
+    printf("%-24s %9.1f %9.1f %10.2f %12.3f\n", result.name,
+           best > 0 ? mb / best : 0, median > 0 ? mb / median : 0,
+           median > 0 ? result.items / median / 1e6 : 0,
+           result.items ? result.allocations / result.items : 0);
+}
+
+static bool writeFile(const char* filename, const std::string& data) {
+    int fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1) {
+        std::cerr << "bench: unable to open " << filename << "\n";
+        return false;
+    }
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n <= 0) {
+            std::cerr << "bench: unable to write " << filename << "\n";
+            close(fd);
+            return false;
+        }
+        written += n;
+    }
+    close(fd);
+    return true;
+}
+
+/*
+ * every kernel of every implementation the CPU can run against scalar, on random buffers: each
+ * is a run of one character class with a few other bytes dropped in, starting at any alignment
+ * and cut at any length, with the bytes past the cut chosen to catch a kernel that reads them
+ */
+static bool checkKernels() {
+    using KERNEL = size_t (*SCAN_KERNELS::*)(const char*, size_t);
+    static const struct { const char* name; KERNEL kernel; } kernels[] = {
+        {"findSpecial", &SCAN_KERNELS::findSpecial}, {"skipWhitespace", &SCAN_KERNELS::skipWhitespace},
+        {"findLineEnd", &SCAN_KERNELS::findLineEnd}, {"findBlockEnd", &SCAN_KERNELS::findBlockEnd},
+        {"skipAlnum", &SCAN_KERNELS::skipAlnum}, {"skipIdentifierTail", &SCAN_KERNELS::skipIdentifierTail},
+        {"skipDigits", &SCAN_KERNELS::skipDigits}, {"skipStringBody", &SCAN_KERNELS::skipStringBody},
+    };
+    static const std::string classes[] = {
+        " \t\n\r\v\f", "abcxyzABCXYZ0189", "abcXYZ019-", "0123456789", "ab Z9-_\t.,!~\x7f", "ab *\n", "",
+    };
+    // anything a kernel may stop at, plus bytes outside ASCII
+    static const char others_bytes[] = "/*\n\"-_.\t \r\x0b\x0c\x00\x01\x1f\x7f\x80\xa0\xff" "aZ09";
+    static const std::string others(others_bytes, sizeof(others_bytes) - 1);
+    const SCAN_KERNELS* tested[] = {sse2Kernels(), avx2Kernels()};
+
+    std::mt19937 rng(1);
+    std::vector<char> buffer(640);
+    for (int trial = 0; trial < 50000; ++trial) {
+        const std::string& run = classes[rng() % (sizeof(classes) / sizeof(classes[0]))];
+        for (char& c : buffer) {
+            c = run.empty() ? static_cast<char>(rng()) : run[rng() % run.size()];
+        }
+        for (int planted = rng() % 4; planted > 0; --planted) {
+            buffer[rng() % buffer.size()] = others[rng() % others.size()];
+        }
+        size_t offset = rng() % 64;
+        size_t n = rng() % (buffer.size() - offset - 2);
+        const char* p = buffer.data() + offset;
+        if (rng() % 4 == 0) {
+            // a match that only exists if the kernel reads past n
+            buffer[offset + n] = others[rng() % others.size()];
+            if (n > 0 && rng() % 2) {
+                buffer[offset + n - 1] = '*';
+                buffer[offset + n] = '/';
+            }
+        }
+        for (const auto& kernel : kernels) {
+            size_t expected = (scalarKernels().*kernel.kernel)(p, n);
+            for (const SCAN_KERNELS* implementation : tested) {
+                if (implementation == nullptr) continue;
+                size_t got = (implementation->*kernel.kernel)(p, n);
+                if (got != expected) {
+                    std::cerr << "bench: " << implementation->name << " " << kernel.name << " returned " << got
+                              << " where scalar returned " << expected << " (length " << n << ", offset " << offset << ")\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void usage() {
+    std::cerr << "usage: urduBench [--input file.ucc | --emit file.ucc] [--size MB] [--seed N]\n"
+                 "                 [--identifiers W] [--numbers W] [--strings W] [--keywords W] [--operators W]\n"
+                 "                 [--distinct N] [--string-length N] [--comments R] [--block-comments R]\n"
+                 "                 [--number-forms W,W,W,W] [--warmup N] [--reps N] [--edits N]\n";
+}
+
+static bool parseOptions(int argc, char* args[], BENCH_OPTIONS& options) {
+    CORPUS_OPTIONS& corpus = options.corpus;
+    for (int i = 1; i < argc; ++i) {
+        const char* flag = args[i];
+        if (i + 1 >= argc) {
+            usage();
+            return false;
+        }
+        const char* value = args[++i];
+        if (!strcmp(flag, "--input")) options.input = value;
+        else if (!strcmp(flag, "--emit")) options.emit = value;
+        else if (!strcmp(flag, "--size")) corpus.size = size_t(atof(value) * (1 << 20));
+        else if (!strcmp(flag, "--seed")) corpus.seed = strtoull(value, nullptr, 10);
+        else if (!strcmp(flag, "--identifiers")) corpus.identifier_weight = atof(value);
+        else if (!strcmp(flag, "--numbers")) corpus.number_weight = atof(value);
+        else if (!strcmp(flag, "--strings")) corpus.string_weight = atof(value);
+        else if (!strcmp(flag, "--keywords")) corpus.keyword_weight = atof(value);
+        else if (!strcmp(flag, "--operators")) corpus.operator_weight = atof(value);
+        else if (!strcmp(flag, "--distinct")) corpus.distinct_identifiers = strtoull(value, nullptr, 10);
+        else if (!strcmp(flag, "--string-length")) corpus.string_length = strtoull(value, nullptr, 10);
+        else if (!strcmp(flag, "--comments")) corpus.comment_ratio = atof(value);
+        else if (!strcmp(flag, "--block-comments")) corpus.block_comment_ratio = atof(value);
+        else if (!strcmp(flag, "--number-forms")) {
+            if (sscanf(value, "%lf,%lf,%lf,%lf", &corpus.number_forms[0], &corpus.number_forms[1],
+                       &corpus.number_forms[2], &corpus.number_forms[3]) != 4) {
+                usage();
+                return false;
+            }
+        }
+        else if (!strcmp(flag, "--warmup")) options.warmup = atoi(value);
+        else if (!strcmp(flag, "--reps")) options.reps = std::max(1, atoi(value));
+        else if (!strcmp(flag, "--edits")) options.edits = std::max(1, atoi(value));
+        else {
+            usage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    BENCH_OPTIONS options;
+    if (!parseOptions(argc, args, options)) {
+        return EXIT_FAILURE;
+    }
+
+    // every benchmark reads the corpus from a file so BUFFER and Scanner see the real load path
+    std::string generated_file;
+    const char* filename = options.input;
+    if (filename == nullptr) {
+        std::string corpus = generateCorpus(options.corpus);
+        if (options.emit) {
+            return writeFile(options.emit, corpus) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        char path[] = "/tmp/urduBench-XXXXXX.ucc";
+        int fd = mkstemps(path, 4);
+        if (fd == -1) {
+            std::cerr << "bench: unable to create corpus file\n";
+            return EXIT_FAILURE;
+        }
+        close(fd);
+        generated_file = path;
+        if (!writeFile(path, corpus)) {
+            return EXIT_FAILURE;
+        }
+        filename = generated_file.c_str();
+    }
+
+    BUFFER input(filename);
+    if (!input.isLoaded()) {
+        std::cerr << "bench: unable to read " << filename << "\n";
+        return EXIT_FAILURE;
+    }
+    std::string_view source(input.data(), input.size());
+    std::ostream discard(nullptr);
+
+    // lexemes for the TABLE::insert benchmark, taken from one lexer run; byte-level
+    // benchmarks report throughput in terms of this token count too
+    std::vector<std::string_view> identifiers, literals;
+    size_t token_count = 0;
+    {
+        TABLE<SYMBOL_TABLE_ENTRY> symbols;
+        TABLE<LITERAL_TABLE_ENTRY> literal_table;
+        Lexer lex(source, symbols, literal_table, discard);
+        while (!lex.isEmpty()) {
+            TOKEN token = lex.getNextToken();
+            if (token.t_class == TOKEN_CLASS::T_EOF) break;
+            ++token_count;
+            std::string_view lexeme = source.substr(token.t_offset, token.t_length);
+            if (token.t_class == TOKEN_CLASS::Identifier) identifiers.push_back(lexeme);
+            else if (token.t_class == TOKEN_CLASS::Number || token.t_class == TOKEN_CLASS::String_Literal) literals.push_back(lexeme);
+        }
+    }
+
+    // the SIMD kernels, and the scanner built on them, must agree with the byte-at-a-time ones
+    // before their speed means anything
+    if (!checkKernels()) {
+        return EXIT_FAILURE;
+    }
+    std::string scalar_scan, simd_scan;
+    scanSource(source.data(), source.size(), scalar_scan, scalarKernels());
+    scanSource(source.data(), source.size(), simd_scan, scanKernels());
+    if (scalar_scan != simd_scan) {
+        std::cerr << "bench: scanSource() with " << scanKernels().name << " kernels differs from scalar\n";
+        return EXIT_FAILURE;
+    }
+
+    printf("corpus: %s, %.1f MiB, %zu identifiers, %zu literals, kernels: %s, %d warmup + %d reps\n\n",
+           options.input ? options.input : "generated", source.size() / double(1 << 20),
+           identifiers.size(), literals.size(), scanKernels().name, options.warmup, options.reps);
+    printf("%-24s %9s %9s %10s %12s\n", "benchmark", "best MB/s", "med MB/s", "Mtokens/s", "allocs/token");
+
+    // scanSource() appends, so every run empties the buffer first and keeps its capacity
+    std::string scanned;
+    report(measure("scanSource (scalar)", source.size(), options, [&]() {
+        scanned.clear();
+        scanSource(source.data(), source.size(), scanned, scalarKernels());
+        return token_count;
+    }));
+    report(measure("scanSource (dispatched)", source.size(), options, [&]() {
+        scanned.clear();
+        scanSource(source.data(), source.size(), scanned, scanKernels());
+        return token_count;
+    }));
+    report(measure("Scanner", source.size(), options, [&]() {
+        Scanner(filename);
+        return token_count;
+    }));
+    report(measure("BUFFER", source.size(), options, [&]() {
+        BUFFER buffer(filename);
+        while (buffer.peekNextCharacter() != __EOF__) {
+            buffer.advance();
+        }
+        return token_count;
+    }));
+    report(measure("Lexer::getNextToken", source.size(), options, [&]() {
+        TABLE<SYMBOL_TABLE_ENTRY> symbols;
+        TABLE<LITERAL_TABLE_ENTRY> literal_table;
+        Lexer lex(source, symbols, literal_table, discard);
+        size_t count = 0;
+        while (!lex.isEmpty()) {
+            if (lex.getNextToken().t_class == TOKEN_CLASS::T_EOF) break;
+            ++count;
+        }
+        return count;
+    }));
+    report(measure("TABLE::insert", source.size(), options, [&]() {
+        TABLE<SYMBOL_TABLE_ENTRY> symbols;
+        TABLE<LITERAL_TABLE_ENTRY> literal_table;
+        for (std::string_view lexeme : identifiers) {
+            symbols.insert(lexeme, SYMBOL_TABLE_ENTRY(TOKEN_CLASS::Identifier));
+        }
+        for (std::string_view lexeme : literals) {
+            literal_table.insert(lexeme, LITERAL_TABLE_ENTRY());
+        }
+        return identifiers.size() + literals.size();
+    }));
+    // each keystroke types a character and deletes it again; MB/s is that of lexing the whole
+    // file once per keystroke, so it compares directly with Lexer::getNextToken
+    {
+        TABLE<SYMBOL_TABLE_ENTRY> symbols;
+        TABLE<LITERAL_TABLE_ENTRY> literal_table;
+        IncrementalLexer incremental(std::string(source), symbols, literal_table);
+        std::mt19937_64 rng(options.corpus.seed);
+        report(measure("IncrementalLexer::edit", source.size() * options.edits, options, [&]() {
+            size_t relexed = 0;
+            for (int i = 0; i < options.edits; ++i) {
+                size_t offset = rng() % (source.size() + 1);
+                relexed += incremental.edit(offset, 0, "_").inserted;
+                relexed += incremental.edit(offset, 1, "").inserted;
+            }
+            return relexed;
+        }));
+    }
+
+    if (!generated_file.empty()) {
+        unlink(generated_file.c_str());
+        unlink((generated_file + ".Meow").c_str());
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "corpus.hpp"
+#include <random>
+#include <vector>
+
+static const char* const KEYWORDS[] = {
+    "Adadi", "Ashriya", "Harf", "Matn", "Mantiqi", "Agar", "Wagarna", "Wapas",
+    "while", "for", "output<-", "input->", "True", "False",
+};
+
+static const char* const OPERATORS[] = {
+    ":=", "::", "+", "-", "*", "/", "%", "<", ">", "!=", "&&", "||", "(", ")", "{", "}", "[", "]",
+};
+
+/*picks an index with probability proportional to its weight*/
+class WEIGHTED_CHOICE {
+    std::vector<double> bounds;
+
+public:
+    WEIGHTED_CHOICE(std::initializer_list<double> weights) {
+        double total = 0;
+        for (double w : weights) bounds.push_back(total += w);
+    }
+
+    template <typename RNG>
+    size_t operator()(RNG& rng) const {
+        double x = std::uniform_real_distribution<double>(0, bounds.back())(rng);
+        size_t i = 0;
+        while (i + 1 < bounds.size() && x >= bounds[i]) ++i;
+        return i;
+    }
+};
+
+static void appendIdentifier(std::string& out, size_t id) {
+    // the lexer only accepts identifiers that contain '_'
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    out += id % 3 == 0 ? "_" : "n_";
+    do {
+        out += letters[id % 52];
+        id /= 52;
+    } while (id != 0);
+}
+
+template <typename RNG>
+static void appendNumber(std::string& out, size_t form, RNG& rng) {
+    std::uniform_int_distribution<int> digits(0, 999999);
+    if (form == 1 || form == 3) out += '-';
+    out += std::to_string(digits(rng));
+    if (form >= 2) {
+        out += '.';
+        out += std::to_string(digits(rng));
+    }
+    if (form == 3) {
+        out += 'E';
+        out += rng() & 1 ? '+' : '-';
+        out += std::to_string(digits(rng) % 300);
+    }
+}
+
+std::string generateCorpus(const CORPUS_OPTIONS& options) {
+    std::mt19937_64 rng(options.seed);
+    WEIGHTED_CHOICE token_kind{options.identifier_weight, options.number_weight, options.string_weight,
+                               options.keyword_weight, options.operator_weight};
+    WEIGHTED_CHOICE number_form{options.number_forms[0], options.number_forms[1],
+                                options.number_forms[2], options.number_forms[3]};
+    std::uniform_int_distribution<size_t> identifier(0, options.distinct_identifiers ? options.distinct_identifiers - 1 : 0);
+    std::uniform_int_distribution<size_t> string_length(options.string_length / 2, options.string_length + options.string_length / 2);
+    std::uniform_int_distribution<size_t> line_length(4, 16);
+    std::uniform_int_distribution<size_t> indent(0, 3);
+    std::bernoulli_distribution comment(options.comment_ratio);
+    std::bernoulli_distribution block_comment(options.block_comment_ratio);
+
+    std::string out;
+    out.reserve(options.size + 256);
+    while (out.size() < options.size) {
+        out.append(indent(rng) * 2, ' ');
+        for (size_t n = line_length(rng); n > 0; --n) {
+            switch (token_kind(rng)) {
+                case 0: appendIdentifier(out, identifier(rng)); break;
+                case 1: appendNumber(out, number_form(rng), rng); break;
+                case 2:
+                    out += '"';
+                    out.append(string_length(rng), 's');
+                    out += '"';
+                    break;
+                case 3: out += KEYWORDS[rng() % (sizeof(KEYWORDS) / sizeof(*KEYWORDS))]; break;
+                default: out += OPERATORS[rng() % (sizeof(OPERATORS) / sizeof(*OPERATORS))]; break;
+            }
+            out += ' ';
+        }
+        if (comment(rng)) {
+            if (block_comment(rng)) {
+                out += "/* generated\n   block comment */";
+            } else {
+                out += "// generated line comment";
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * knobs for the synthetic .ucc generator. the *_weight fields pick what each
+ * generated token is; they are relative and need not sum to one.
+ */
+struct CORPUS_OPTIONS {
+    size_t size = 16u << 20;            // bytes to generate
+    uint64_t seed = 1;
+
+    double identifier_weight = 0.35;
+    double number_weight = 0.15;
+    double string_weight = 0.05;
+    double keyword_weight = 0.15;
+    double operator_weight = 0.30;
+
+    size_t distinct_identifiers = 4096;
+    size_t string_length = 24;          // average, actual lengths vary by +-50%
+    double comment_ratio = 0.10;        // fraction of lines that carry a comment
+    double block_comment_ratio = 0.25;  // of those, how many are /* */ rather than //
+    // numeric literal forms in order: 42, -42, 10.5, -10.5E+12
+    double number_forms[4] = {0.4, 0.2, 0.2, 0.2};
+};
+
+// deterministic for a given set of options
+std::string generateCorpus(const CORPUS_OPTIONS& options);
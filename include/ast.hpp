@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "token_kind.hpp"
+
+enum NODE_KIND : uint8_t {
+    NODE_PROGRAMME,     // top level functions and declarations
+    NODE_FUNCTION,      // parameters..., body
+    NODE_PARAM,
+    NODE_DECLARATION,   // declared names
+    NODE_BLOCK,         // statements
+    NODE_IF,            // condition, then [, else]
+    NODE_WHILE,         // condition, body
+    NODE_FOR,           // init, condition, step, body
+    NODE_RETURN,        // value
+    NODE_EXPR_STMT,     // expression
+    NODE_OUTPUT,        // expression or string
+    NODE_INPUT,         // identifier read into
+    NODE_EMPTY,         // `::` on its own, or a missing for clause
+    NODE_ASSIGN,        // target, value
+    NODE_BINARY,        // left, right
+    NODE_IDENTIFIER,
+    NODE_NUMBER,
+    NODE_BOOLEAN,       // True or False, op is KW_TRUE or KW_FALSE
+    NODE_CALL,          // arguments; token is the function's name
+    NODE_STRING,
+    NODE_ERROR,         // a statement or top level item skipped by error recovery
+    NODE_KIND_COUNT
+};
+
+const char* nodeKindName(NODE_KIND kind);
+
+/*
+ * token is an index into the parser's TokenStream: the name of a function, parameter,
+ * identifier or called function, the literal of a number or string, the operator of a binary node, and the last token
+ * of anything else, which is enough for a line number.
+ */
+struct AST_NODE {
+    NODE_KIND kind;
+    TOKEN_KIND op;          // operator of NODE_BINARY, declared type of NODE_FUNCTION, NODE_PARAM, NODE_DECLARATION
+    uint32_t child_count;
+    uint32_t first_child;   // index into the child list array
+    uint32_t token;
+};
+
+static_assert(sizeof(AST_NODE) == 16, "AST_NODE should stay four words");
+static_assert(std::is_trivially_copyable<AST_NODE>::value, "AST_NODE is stored by value in a flat array");
+
+/*
+ * abstract syntax tree in two flat arrays: nodes, and the child lists they point into.
+ * nodes refer to each other by 32-bit index and each node's children are contiguous.
+ * the parser builds bottom up, so nodes are stored in post-order (children before their
+ * parent, root last) and a pass that walks the array front to back reads it in cache order.
+ * reset() drops the whole tree at once and keeps the memory for the next one.
+ */
+class AST {
+public:
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    /*range over a node's child indices*/
+    struct CHILDREN {
+        const uint32_t* first;
+        const uint32_t* last;
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        uint32_t size() const { return static_cast<uint32_t>(last - first); }
+        uint32_t operator[](uint32_t i) const { return first[i]; }
+    };
+
+    uint32_t add(NODE_KIND kind, TOKEN_KIND op, uint32_t token, const uint32_t* children, uint32_t count);
+    void reserve(size_t node_count);
+    void reset();
+    // copies every node of tree but its root, with token indices moved up by token_base;
+    // the root's children are appended to roots as indices into this tree
+    void append(const AST& tree, uint32_t token_base, std::vector<uint32_t>& roots);
+
+    const AST_NODE& operator[](uint32_t node) const { return nodes[node]; }
+    uint32_t size() const { return static_cast<uint32_t>(nodes.size()); }
+    bool empty() const { return nodes.empty(); }
+    uint32_t root() const { return nodes.empty() ? NO_NODE : size() - 1; }
+    CHILDREN children(uint32_t node) const {
+        const uint32_t* first = links.data() + nodes[node].first_child;
+        return {first, first + nodes[node].child_count};
+    }
+
+private:
+    std::vector<AST_NODE> nodes;
+    std::vector<uint32_t> links;    // child lists, one contiguous run per node
+};
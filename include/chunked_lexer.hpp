@@ -0,0 +1,24 @@
+#pragma once
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include "lexer.hpp"
+
+/*
+ * offsets where source can be cut for parallel lexing: just past a newline that a
+ * quick scan places outside any string literal or comment. the first entry is 0, the
+ * last is source.size(), and there are at most `chunks` ranges in between.
+ */
+std::vector<size_t> findChunkBoundaries(std::string_view source, size_t chunks);
+
+/*
+ * lexes source on up to `threads` workers and appends the result to tokens.
+ * token stream, table ids and lex errors match the serial getNextToken loop; a chunk
+ * whose lexer ran off its end mid-token is merged with the chunks after it and re-lexed,
+ * doubling the number merged until the lexer ends cleanly, so no byte is lexed more than
+ * a few times over.
+ */
+void lexChunked(std::string_view source, unsigned threads,
+                TABLE<SYMBOL_TABLE_ENTRY>& symbol_table, TABLE<LITERAL_TABLE_ENTRY>& literal_table,
+                TokenStream& tokens, std::ostream& diagnostics = std::cout);
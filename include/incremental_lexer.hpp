@@ -0,0 +1,60 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lexer.hpp"
+
+/*
+ * a document and its token stream, kept up to date across edits without lexing it again.
+ * the DFA is back at START at the start of every token, with no comment or string open,
+ * so each token's offset and line in the TokenStream is a restart point. edit() resumes
+ * lexing at the last token that starts before the change and stops as soon as a new token
+ * starts where an old one did past the change: from there on the text, and so the
+ * tokens, are the old ones moved by the size of the edit.
+ *
+ * new lexemes go into the same symbol and literal TABLEs, so ids stay those of a full lex.
+ * lex errors are kept with the offset of the token after them (the end of the text for
+ * errors after the last token): the ones a re-lexed stretch had are replaced by the ones it
+ * has now, so errors() is always what lexing the whole text would report.
+ */
+class IncrementalLexer {
+public:
+    /*tokens [first, first + inserted) of the new stream replace [first, first + removed) of the old one*/
+    struct RELEXED {
+        size_t first;
+        size_t removed;
+        size_t inserted;
+    };
+
+    struct LEX_ERROR {
+        size_t offset;
+        std::string message;    // one line, without its newline
+    };
+
+    IncrementalLexer(std::string text, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable);
+    IncrementalLexer(const IncrementalLexer&) = delete;
+    IncrementalLexer& operator=(const IncrementalLexer&) = delete;
+
+    // replaces length bytes at offset with replacement
+    RELEXED edit(size_t offset, size_t length, std::string_view replacement);
+
+    std::string_view text() const { return document; }
+    const TokenStream& tokens() const { return token_stream; }
+    const std::vector<LEX_ERROR>& errors() const { return lex_errors; }
+    // false if the DFA ran off the end of the text, as Lexer::endedClean()
+    bool endedClean() const { return ends_clean; }
+
+private:
+    std::string document;
+    TokenStream token_stream;
+    std::vector<LEX_ERROR> lex_errors;      // by offset
+    bool ends_clean = true;
+    TABLE<SYMBOL_TABLE_ENTRY>& symbol_table;
+    TABLE<LITERAL_TABLE_ENTRY>& literal_table;
+    std::ostringstream messages;
+
+    // moves what the lexer has reported since the last call into errors, at offset
+    void collectErrors(std::vector<LEX_ERROR>& errors, size_t offset);
+};
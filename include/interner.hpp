@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+ * string interner. bytes are copied once into a bump arena and never move, so the
+ * returned views stay valid for the interner's lifetime. ids are dense and handed
+ * out in insertion order, which lets TABLE use them directly as entry indices.
+ */
+class INTERNER {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    INTERNER();
+    INTERNER(const INTERNER&) = delete;
+    INTERNER& operator=(const INTERNER&) = delete;
+
+    // returns the id of s, copying it into the arena the first time it is seen
+    uint32_t intern(std::string_view s);
+    // returns the id of s or NOT_FOUND, never allocates
+    uint32_t find(std::string_view s) const;
+
+    std::string_view get(uint32_t id) const { return strings[id]; }
+    uint32_t size() const { return static_cast<uint32_t>(strings.size()); }
+
+    static uint32_t hash(std::string_view s);
+
+private:
+    /*open addressing slot; id 0 marks an empty slot so ids are stored plus one*/
+    struct SLOT {
+        uint32_t hash;
+        uint32_t id_plus_one;
+    };
+
+    static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+    std::vector<SLOT> slots;    // power of two, at most half full
+    std::vector<std::string_view> strings;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* arena_cursor = nullptr;
+    size_t arena_left = 0;
+
+    size_t probe(std::string_view s, uint32_t h) const;
+    const char* copyToArena(std::string_view s);
+    void grow();
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "token_kind.hpp"
+
+constexpr size_t KEYWORD_MIN_LENGTH = 2;
+constexpr size_t KEYWORD_MAX_LENGTH = 9;
+constexpr int KEYWORD_HASH_BITS = 8;
+
+/*hashes the length and the first two and last two bytes, so lookups cost the same for any lexeme*/
+constexpr uint32_t keywordHash(std::string_view lexeme, uint32_t seed) {
+    uint32_t h = seed ^ (static_cast<uint32_t>(lexeme.size()) * 0x9E3779B1u);
+    const char bytes[4] = { lexeme[0], lexeme[1], lexeme[lexeme.size() - 2], lexeme[lexeme.size() - 1] };
+    for (char c : bytes) {
+        h = (h ^ static_cast<unsigned char>(c)) * 0x01000193u;
+    }
+    return h >> (32 - KEYWORD_HASH_BITS);
+}
+
+struct KEYWORD_HASH {
+    uint32_t seed;
+    uint8_t slots[1 << KEYWORD_HASH_BITS];
+};
+
+/*searches, at compile time, for the first seed that maps every keyword to its own slot*/
+constexpr KEYWORD_HASH buildKeywordHash() {
+    for (uint32_t seed = 1; ; ++seed) {
+        KEYWORD_HASH table{ seed, {} };
+        bool perfect = true;
+        for (int k = KEYWORD_FIRST; k < KEYWORD_END && perfect; ++k) {
+            uint8_t& slot = table.slots[keywordHash(TOKEN_KIND_SPELLINGS[k], seed)];
+            perfect = slot == TK_NONE;
+            slot = static_cast<uint8_t>(k);
+        }
+        if (perfect) {
+            return table;
+        }
+    }
+}
+
+inline constexpr KEYWORD_HASH KEYWORD_TABLE = buildKeywordHash();
+
+// keyword kind of lexeme, TK_NONE if it is not a keyword
+constexpr TOKEN_KIND lookupKeyword(std::string_view lexeme) {
+    if (lexeme.size() < KEYWORD_MIN_LENGTH || lexeme.size() > KEYWORD_MAX_LENGTH) {
+        return TK_NONE;
+    }
+    TOKEN_KIND keyword = static_cast<TOKEN_KIND>(KEYWORD_TABLE.slots[keywordHash(lexeme, KEYWORD_TABLE.seed)]);
+    return TOKEN_KIND_SPELLINGS[keyword] == lexeme ? keyword : TK_NONE;
+}
+
+constexpr bool keywordTableIsComplete() {
+    for (int k = KEYWORD_FIRST; k < KEYWORD_END; ++k) {
+        if (TOKEN_KIND_SPELLINGS[k].size() < KEYWORD_MIN_LENGTH || TOKEN_KIND_SPELLINGS[k].size() > KEYWORD_MAX_LENGTH ||
+            lookupKeyword(TOKEN_KIND_SPELLINGS[k]) != k) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(keywordTableIsComplete(), "every keyword must round-trip through lookupKeyword");
@@ -4,17 +4,22 @@
 #include <iostream>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
-#include <map>
-#include <set>
-#include <functional>
 #include <cctype>
+#include <cstdint>
+#include <type_traits>
 #include <optional>
+#include <string_view>
+#include <cstring>
+#include "keyword.hpp"
+#include "interner.hpp"
+#include "simd.hpp"
 #include <ctime>
 
-#define BUFFER_SIZE 25
 #define __EOF__ '\0'
 
 const std::string ROLL_NO = "22L-6895_";
@@ -44,6 +49,7 @@ enum STATE : u_int8_t {
     P_COLON,
     P_FINAL,
     O_FINAL,
+    O_PAIR,
     SL1,
     SL_FINAL,
     K_CHECK,
@@ -51,12 +57,18 @@ enum STATE : u_int8_t {
     K_OUTPUT_LT,
     K_INPUT_SUB,
     K_INPUT,
-    K_FINAL
+    K_FINAL,
+    O_SLASH,
+    C_LINE,
+    C_BLOCK,
+    C_BLOCK_STAR,
+    C_END,
+    STATE_COUNT
 };
 
 std::string getStateName(STATE state);
 
-enum TOKEN_CLASS {
+enum TOKEN_CLASS : uint8_t {
     ERROR,
     Keyword,
     Operator,
@@ -68,139 +80,236 @@ enum TOKEN_CLASS {
 };
 
 enum DATA_TYPE {
-    T_DEFAULT
+    T_DEFAULT,
+    T_ADADI,        // integer
+    T_ASHRIYA,      // decimal
+    T_HARF,         // character
+    T_MATN,         // string
+    T_MANTIQI       // boolean
 };
 
 std::string tokenClassToString(TOKEN_CLASS token);
 std::string dataTypeToString(DATA_TYPE type);
+// the type a type keyword names, T_DEFAULT for any other token
+DATA_TYPE dataTypeOf(TOKEN_KIND type_keyword);
 
+/*
+ * 16-byte token. t_id is the symbol or literal table index for identifiers, numbers and
+ * strings and -1 otherwise; every token keeps where its lexeme starts in the source.
+ */
 struct TOKEN {
-    ssize_t t_id;
-    std::optional<std::string> t_lexeme;
     TOKEN_CLASS t_class;
-    int line_number;
-    int column_number;
+    TOKEN_KIND t_kind;
+    uint16_t t_length;    // saturates at 0xFFFF; lexemeAt() lexes such a token again to find its end
+    int32_t t_id;
+    uint32_t t_offset;
+    uint32_t line_number;
+
+    TOKEN() = default;
+    TOKEN(TOKEN_CLASS tclass, int32_t id, size_t offset, size_t length, uint32_t line, TOKEN_KIND kind = TK_NONE);
+};
+
+static_assert(sizeof(TOKEN) == 16, "TOKEN must stay 16 bytes");
+static_assert(std::is_trivially_copyable<TOKEN>::value, "TOKEN must be trivially copyable");
+
+/*token stream stored as parallel arrays; lexemes are rebuilt from the source on demand*/
+class TokenStream {
+    std::string_view source;
+    std::vector<TOKEN_CLASS> classes;
+    std::vector<TOKEN_KIND> kinds;
+    std::vector<int32_t> ids;
+    std::vector<uint32_t> offsets;
+    std::vector<uint16_t> lengths;
+    std::vector<uint32_t> lines;
 
-    TOKEN(ssize_t id=-1, const std::optional<std::string>& lexeme = std::nullopt, TOKEN_CLASS tclass = TOKEN_CLASS::ERROR, int line = 0, int column = 0);
-    std::string toString() const;
+public:
+    explicit TokenStream(std::string_view source = std::string_view());
+    void push_back(const TOKEN& token);
+    void reserve(size_t count);
+    size_t size() const { return classes.size(); }
+    bool empty() const { return classes.empty(); }
+    TOKEN operator[](size_t i) const;
+    TOKEN_CLASS tokenClass(size_t i) const { return classes[i]; }
+    TOKEN_KIND kind(size_t i) const { return kinds[i]; }
+    int32_t id(size_t i) const { return ids[i]; }
+    uint32_t offset(size_t i) const { return offsets[i]; }
+    uint32_t line(size_t i) const { return lines[i]; }
+    std::string_view lexeme(size_t i) const;
+    std::string toString(size_t i) const;
+    std::string_view text() const { return source; }
+    void setText(std::string_view text) { source = text; }
+    // replaces tokens [first, last) with every token of replacement
+    void replace(size_t first, size_t last, const TokenStream& replacement);
+    // moves tokens from `from` on by offset bytes and line_count lines, back for negative ones
+    void shift(size_t from, int64_t offset, int64_t line_count);
+    // index of the first token starting at or after offset
+    size_t tokenAt(size_t offset) const;
 };
 
+/*table entries hold only attributes; the lexeme itself lives once in the TABLE's interner*/
 struct SYMBOL_TABLE_ENTRY {
     TOKEN_CLASS token_class;
-    std::string lexeme;
     DATA_TYPE datatype;
     size_t memory_location;
 
-    SYMBOL_TABLE_ENTRY(TOKEN_CLASS _class = TOKEN_CLASS::ERROR, const std::string& _lexeme = "", DATA_TYPE _datatype = DATA_TYPE::T_DEFAULT, size_t _memory_location = 0);
-    std::string toString() const;
+    SYMBOL_TABLE_ENTRY(TOKEN_CLASS _class = TOKEN_CLASS::ERROR, DATA_TYPE _datatype = DATA_TYPE::T_DEFAULT, size_t _memory_location = 0);
+    std::string toString(std::string_view lexeme) const;
 };
 
+/*
+ * string literals are keyed by their lexeme. numbers are converted when they are lexed and
+ * keyed by type and value (numberKey()), so 10.5, 10.50 and 1.05E+1 share one entry and
+ * nothing has to parse the lexeme again.
+ */
 struct LITERAL_TABLE_ENTRY {
-    std::string value;
     DATA_TYPE datatype;
+    union {
+        int64_t integer;    // T_ADADI, T_MANTIQI, and T_HARF as a value rather than a lexeme
+        double decimal;     // T_ASHRIYA
+    };
 
-    LITERAL_TABLE_ENTRY(const std::string& _value = "", DATA_TYPE _datatype = DATA_TYPE::T_DEFAULT);
-    std::string toString() const;
+    LITERAL_TABLE_ENTRY(DATA_TYPE _datatype = DATA_TYPE::T_DEFAULT);
+    explicit LITERAL_TABLE_ENTRY(int64_t value);
+    explicit LITERAL_TABLE_ENTRY(double value);
+    explicit LITERAL_TABLE_ENTRY(bool value);   // T_MANTIQI, held in integer as 0 or 1
+    std::string toString(std::string_view value) const;
 };
 
+// the literal table key of a number or boolean entry: its type and the bytes of its value
+std::string_view numberKey(const LITERAL_TABLE_ENTRY& number, char (&key)[9]);
+
+/*entries indexed by the interner id of their lexeme*/
 template <typename T>
 class TABLE {
-    std::unordered_map<std::string, size_t> lexeme_to_index;
+    INTERNER names;
     std::vector<T> entries;
 
 public:
-    const T* find(const std::string& lexeme) const {
-        auto it = lexeme_to_index.find(lexeme);
-        if (it != lexeme_to_index.end()) {
-            return &entries[it->second];
-        }
-        return nullptr;
+    const T* find(std::string_view lexeme) const {
+        uint32_t id = names.find(lexeme);
+        return id == INTERNER::NOT_FOUND ? nullptr : &entries[id];
     }
 
-    size_t insert(const std::string& lexeme, const T& entry) {
-        auto it = lexeme_to_index.find(lexeme);
-        if (it != lexeme_to_index.end()) {
-            return it->second;
+    uint32_t insert(std::string_view lexeme, const T& entry) {
+        uint32_t id = names.intern(lexeme);
+        if (id == entries.size()) {
+            entries.push_back(entry);
         }
-
-        size_t index = entries.size();
-        entries.push_back(entry);
-        lexeme_to_index[lexeme] = index;
-        return index;
+        return id;
     }
 
+    std::string_view lexeme(uint32_t id) const { return names.get(id); }
+    const T& operator[](uint32_t id) const { return entries[id]; }
+    size_t size() const { return entries.size(); }
     bool writeToFile(const std::string& filename) const;
 };
 
-class Transitions {
-    STATE error_state = STATE::ERROR_STATE;
-    std::unordered_map<char, STATE> transitions;
-    std::unordered_map<std::string, STATE> keyword_transitions;
-    std::vector<std::pair<std::function<bool(char)>, STATE>> transition_functions;
-    static const std::set<char> valid_chars;
+// id of the literal table entry for a number or boolean value, added if no literal had it yet
+inline uint32_t insertValue(TABLE<LITERAL_TABLE_ENTRY>& literal_table, const LITERAL_TABLE_ENTRY& value) {
+    char key[9];
+    return literal_table.insert(numberKey(value, key), value);
+}
 
-public:
-    STATE operator[](char character);
-    STATE operator[](const std::string& keyword);
-    STATE& operator()(char character);
-    STATE& operator()(const std::string& keyword);
-    STATE& operator()(const std::function<bool(char)> func);
-    static bool isValidCharacter(char c);
+/*dense DFA: one row of 256 next states per state, built at compile time*/
+struct DFA_TABLE {
+    STATE next[STATE_COUNT][256];
 };
 
-class TRANSITION_TABLE {
-    std::unordered_map<STATE, Transitions> table;
-    std::unordered_set<STATE> final_states{
-        STATE::N_FINAL, 
-        STATE::O_FINAL,
-        STATE::P_FINAL,
-        STATE::I_FINAL,
-        STATE::K_FINAL,
-        STATE::K_CHECK,
-        STATE::SL_FINAL,
-    };
+constexpr uint64_t stateBit(STATE s) { return uint64_t(1) << s; }
 
-    std::unordered_set<STATE> not_advance = {
-        STATE::N1,
-        STATE::N_DECIMAL_N,
-        STATE::N_EXP_N,
-        STATE::I1,
-        STATE::I_UND,
-        STATE::O_LT,
-        STATE::O_GT,
-        STATE::O_ET,
-        STATE::O_ADD,
-        STATE::O_SUBTRACT
-    };
+class TRANSITION_TABLE {
+    static const DFA_TABLE dfa;
+
+    static constexpr uint64_t final_states =
+        stateBit(STATE::N_FINAL) |
+        stateBit(STATE::O_FINAL) |
+        stateBit(STATE::O_PAIR) |
+        stateBit(STATE::P_FINAL) |
+        stateBit(STATE::I_FINAL) |
+        stateBit(STATE::K_FINAL) |
+        stateBit(STATE::K_CHECK) |
+        stateBit(STATE::SL_FINAL) |
+        stateBit(STATE::C_END);
+
+    static constexpr uint64_t not_advance =
+        stateBit(STATE::N1) |
+        stateBit(STATE::N_DECIMAL_N) |
+        stateBit(STATE::N_EXP_N) |
+        stateBit(STATE::I1) |
+        stateBit(STATE::I_UND) |
+        stateBit(STATE::O_LT) |
+        stateBit(STATE::O_GT) |
+        stateBit(STATE::O_ET) |
+        stateBit(STATE::O_ADD) |
+        stateBit(STATE::O_SUBTRACT) |
+        stateBit(STATE::O_SLASH);
+
+    // states whose characters are discarded as they are read
+    static constexpr uint64_t comment_states =
+        stateBit(STATE::C_LINE) |
+        stateBit(STATE::C_BLOCK) |
+        stateBit(STATE::C_BLOCK_STAR);
+
+    // states that loop on themselves over a character class; the lexer jumps over such runs
+    static constexpr uint64_t run_states =
+        stateBit(STATE::I1) |
+        stateBit(STATE::I_UND) |
+        stateBit(STATE::N1) |
+        stateBit(STATE::N_DECIMAL_N) |
+        stateBit(STATE::N_EXP_N) |
+        stateBit(STATE::SL1);
+
+    static_assert(STATE_COUNT <= 64, "state masks are 64 bits wide");
 
 public:
-    Transitions& operator[](STATE state);
-    bool isFinal(STATE s);
-    bool advance(STATE previous_state, STATE new_state);
-    TOKEN_CLASS getTokenClass(STATE s);
+    static STATE next(STATE state, char character) {
+        return dfa.next[state][static_cast<unsigned char>(character)];
+    }
+    static STATE next(STATE state, std::string_view keyword);
+    static bool isFinal(STATE s) { return (final_states & stateBit(s)) != 0; }
+    static bool isComment(STATE s) { return (comment_states & stateBit(s)) != 0; }
+    static bool hasRun(STATE s) { return ((comment_states | run_states) & stateBit(s)) != 0; }
+    // O_PAIR always keeps its second character, even when coming from a not_advance state
+    static bool advance(STATE previous_state, STATE new_state) {
+        return !isFinal(new_state) || new_state == STATE::O_PAIR || (not_advance & stateBit(previous_state)) == 0;
+    }
+    static TOKEN_CLASS getTokenClass(STATE s);
 };
 
+/*whole source in memory: mmap for regular files, read() loop for pipes; lexemes are views into it*/
 class BUFFER {
 private:
-    int in_file_descriptor;  
-    char buffer[2][BUFFER_SIZE+1];
-    int buffer_in_use;  // 0 or 1, to track active buffer
-    int bp, fp; 
-    int current_lexeme_size = 0;
-    ssize_t current_buffer_size; 
+    const char* source = nullptr;
+    size_t source_size = 0;
+    bool mapped = false;
+    std::string streamed;   // backing storage when the input cannot be mapped
+    size_t bp = 0, fp = 0;
+    int line = 1;
+    int column = 1;
 
-    bool loadBuffer();
+    void release();
+    bool readStream(int fd);
 
 public:
     BUFFER(const char* filename = nullptr);
+    BUFFER(const BUFFER&) = delete;
+    BUFFER& operator=(const BUFFER&) = delete;
     ~BUFFER();
     bool setFile(const char* filename);
-    bool isDescriptorSet();
-    char peekNextCharacter();
+    void setView(std::string_view text);
+    bool isLoaded() const;
+    const char* data() const;
+    size_t size() const;
+    std::string_view remaining() const;
+    size_t lexemeStart() const;
+    char peekNextCharacter() const;
     bool advance();
-    bool advanceBp();
-    std::string peekLexeme();
-    std::string popLexeme();
+    void skip(size_t count);
+    std::string_view peekLexeme() const;
+    std::string_view popLexeme();
+    void dropLexeme();
+    int getLine() const;
+    int getColumn() const;
 };
 
 class Lexer {
@@ -208,25 +317,40 @@ private:
     BUFFER buffer;
     TABLE<SYMBOL_TABLE_ENTRY>& symbol_table;
     TABLE<LITERAL_TABLE_ENTRY>& literal_table;
-
-    TRANSITION_TABLE transition_table;
-    std::unordered_set<std::string>& keywords;
+    const SCAN_KERNELS& kernels;
+    std::ostream& diagnostics;
 
     int current_token_lines = 1;
-    int current_token_columns = 0;
+    bool ends_clean = true;
+    bool loaded = false;
 
-    bool loadTransitions();
     std::string getErrorStatement(STATE state, STATE new_state);
+    int32_t insertNumber(std::string_view lexeme);
+    void skipWhitespace();
+    void skipRun(STATE state);
 
 public:
-    Lexer(const char* filename, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable, std::unordered_set<std::string>& kw);
+    Lexer(const char* filename, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable);
+    // lexes text in place; the caller keeps it alive
+    Lexer(std::string_view text, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable, std::ostream& diag);
     bool setBuffer(const char* filename);
+    // false if the file given to the constructor or setBuffer() could not be read
+    bool ok() const { return loaded; }
     inline void transition(STATE &state, STATE &new_state, const STATE &next_state);
     TOKEN getNextToken();
     bool isEmpty();
+    std::string_view source() const;
+    // false once the DFA had to look past the last byte to finish a token, string or comment
+    bool endedClean() const;
+    // bytes lexed so far, up to the end of the last token or comment
+    size_t position() const;
 };
 
+// the lexeme of a token in text; one whose length saturated is lexed again from its offset
+std::string_view lexemeAt(std::string_view text, uint32_t offset, uint16_t length);
+
+void scanSource(const char* source, size_t size, std::string& scanned, const SCAN_KERNELS& kernels);
 int Scanner(const char *filename);
-bool writeTokenToFile(std::vector<TOKEN>& token_stream, std::string& filename);
+bool writeTokenToFile(const TokenStream& token_stream, std::string& filename);
 
 #endif // LEXER_HPP
\ No newline at end of file
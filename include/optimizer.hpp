@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include "lexer.hpp"
+#include "scope.hpp"
+#include "tac.hpp"
+
+struct OPTIMIZE_STATS {
+    size_t quads = 0;       // before optimizing
+    size_t removed = 0;
+    size_t folded = 0;      // computations replaced by their constant value
+    size_t branches = 0;    // conditional jumps whose outcome was known
+};
+
+/*
+ * -O1, one function at a time. each function is cut into basic blocks, then sparse
+ * conditional constant propagation finds which blocks can run and which values are
+ * constant: a block is only looked at once a branch that can be taken reaches it, and a
+ * value is only re-evaluated when one of its operands changes, each of which happens a
+ * bounded number of times, so the whole pass is linear in the size of the function.
+ *
+ * there is no SSA form. temporaries never outlive their block, and a variable read in the
+ * block that assigned it sees that assignment; any other read sees the meet of every
+ * assignment that is last in its block. globals, parameters, call results and input are
+ * never constant, and a call ends what a block knows about globals. folding follows the
+ * rules in tac.hpp; Adadi arithmetic that would overflow or divide by zero is left for run time.
+ *
+ * afterwards unreachable blocks are dropped, decided branches become jumps or nothing,
+ * constants replace the operands they flow into, and assignments nothing reads are removed
+ * along with whatever only they used, except Adadi divisions whose divisor is not a constant
+ * other than 0 and -1, which may still stop the programme. labels nothing jumps to go too;
+ * their entries in tac.labels become TAC::NO_QUAD. new constants are added to literal_table.
+ */
+OPTIMIZE_STATS optimizeTAC(TAC& tac, const NAME_BINDINGS& names, TABLE<LITERAL_TABLE_ENTRY>& literal_table);
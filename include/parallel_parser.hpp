@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include "ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+
+/*
+ * parses tokens on up to `threads` workers. splitTopLevel() cuts the stream into whole top
+ * level items, each worker parses runs of them with its own Parser, and the trees are joined
+ * in source order. tree and diagnostics match Parser<>::programme() on the whole stream: if
+ * any run has a syntax error the stream is parsed again serially, since recovery may skip
+ * from one item into the next. token indices in tree refer to tokens.
+ */
+bool parseParallel(const TokenStream& tokens, unsigned threads, AST& tree, std::vector<DIAGNOSTIC>& diagnostics);
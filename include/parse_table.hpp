@@ -0,0 +1,126 @@
+// generated by tools/llgen from doc/CFG.txt, do not edit
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "keyword.hpp"
+
+/*terminals first, then nonterminals, then actions; PARSE_TABLE is indexed by the first two*/
+enum GRAMMAR_SYMBOL : uint8_t {
+    TS_IDENTIFIER,
+    TS_LPAREN,
+    TS_RPAREN,
+    TS_TERMINATOR,
+    TS_ADADI,
+    TS_ASHRIYA,
+    TS_HARF,
+    TS_MATN,
+    TS_MANTIQI,
+    TS_COMMA,
+    TS_FOR,
+    TS_WHILE,
+    TS_AGAR,
+    TS_WAGARNA,
+    TS_LBRACE,
+    TS_RBRACE,
+    TS_WAPAS,
+    TS_OUTPUT,
+    TS_STRING,
+    TS_INPUT,
+    TS_NUMBER,
+    TS_TRUE,
+    TS_FALSE,
+    TS_ASSIGN,
+    TS_EQ,
+    TS_LT,
+    TS_GT,
+    TS_LE,
+    TS_GE,
+    TS_NE,
+    TS_LTGT,
+    TS_PLUS,
+    TS_MINUS,
+    TS_STAR,
+    TS_SLASH,
+    TS_EOF,
+    TS_UNKNOWN,
+    NT_PROGRAMME,
+    NT_TOPLEVEL,
+    NT_TOPLEVEL_1,
+    NT_TYPE,
+    NT_ARGLIST,
+    NT_ARGLIST_1,
+    NT_DECLARATION,
+    NT_IDENTLIST,
+    NT_STMT,
+    NT_NOIFSTMT,
+    NT_FORSTMT,
+    NT_OPTEXPR,
+    NT_WHILESTMT,
+    NT_IFSTMT,
+    NT_ELSEPART,
+    NT_COMPSTMT,
+    NT_STMTLIST,
+    NT_RETURNSTMT,
+    NT_OUTPUTSTMT,
+    NT_OUTPUT,
+    NT_INPUTSTMT,
+    NT_EXPR,
+    AS_TOKEN,
+    AS_MARK,
+    AS_FUNCTION,
+    AS_GLOBAL,
+    AS_PARAM,
+    AS_IDENTIFIER,
+    AS_DECLARATION,
+    AS_EXPR_STMT,
+    AS_EMPTY,
+    AS_FOR,
+    AS_WHILE,
+    AS_IF,
+    AS_BLOCK,
+    AS_RETURN,
+    AS_OUTPUT,
+    AS_STRING,
+    AS_INPUT,
+    GRAMMAR_SYMBOL_COUNT
+};
+
+constexpr int TERMINAL_COUNT = TS_UNKNOWN + 1;
+constexpr int FIRST_ACTION = 59;
+constexpr int NONTERMINAL_COUNT = FIRST_ACTION - TERMINAL_COUNT;
+constexpr GRAMMAR_SYMBOL START_SYMBOL = NT_PROGRAMME;
+constexpr uint8_t NO_PRODUCTION = 0xFF;
+
+struct PRODUCTION {
+    GRAMMAR_SYMBOL lhs;
+    uint8_t length;
+    uint16_t first;     // index of the first right-hand side symbol in PRODUCTION_SYMBOLS
+};
+
+extern const PRODUCTION PRODUCTIONS[];
+extern const GRAMMAR_SYMBOL PRODUCTION_SYMBOLS[];
+extern const uint8_t PARSE_TABLE[NONTERMINAL_COUNT][TERMINAL_COUNT];
+// spelling of each terminal, parse tree node name of each nonterminal, @name of each action
+extern const char* const GRAMMAR_SYMBOL_NAMES[GRAMMAR_SYMBOL_COUNT];
+// terminal each token kind is matched as; TS_UNKNOWN for kinds the grammar never uses
+extern const std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> KIND_TERMINALS;
+// binding power of each binary operator from the %left/%right levels, loosest 1; 0 for other kinds
+extern const std::array<uint8_t, TOKEN_KIND_COUNT> BINDING_POWERS;
+constexpr uint8_t BINDING_POWER_LEVELS = 4;
+
+inline bool isTerminal(GRAMMAR_SYMBOL symbol) {
+    return symbol < TERMINAL_COUNT;
+}
+
+inline bool isAction(GRAMMAR_SYMBOL symbol) {
+    return symbol >= FIRST_ACTION;
+}
+
+inline GRAMMAR_SYMBOL terminalOf(TOKEN_KIND kind) {
+    return KIND_TERMINALS[kind];
+}
+
+inline bool isRightAssociative(uint8_t power) {
+    return power > 0 && (1u >> (power - 1) & 1u);
+}
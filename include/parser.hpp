@@ -1,61 +1,120 @@
 #pragma once
 
+#include <string>
+#include <string_view>
 #include <vector>
+#include "ast.hpp"
 #include "lexer.hpp"
+#include "parse_table.hpp"
+#include "token_source.hpp"
+#include "tree_sink.hpp"
 
+struct DIAGNOSTIC {
+    uint32_t line;      // 0 at end of file
+    uint32_t token;     // index of the offending token; the token count at end of file
+    std::string message;
 
+    std::string toString() const;
+};
 
-
+/*
+ * table-driven LL(1) parser. the grammar lives in doc/CFG.txt and the table in
+ * parse_table.cpp; programme() runs an explicit stack instead of recursing, so
+ * long statement lists and operator chains cost stack entries, not native frames.
+ * the grammar's @actions build the AST as the parse goes; tree() is valid once
+ * programme() has returned, and its token indices refer to tokenStream().
+ * SINK receives the parse tree (tree_sink.hpp); the default NULL_SINK compiles it away.
+ * SOURCE supplies the tokens (token_source.hpp): a lexed TokenStream, or a TOKEN_RING
+ * that a lexer thread fills while the parse runs.
+ *
+ * syntax errors do not stop the parse. each one is added to diagnostics(), the statement
+ * or top level item it is in is skipped up to the next `::`, `}` or type keyword and
+ * replaced by a NODE_ERROR, and parsing carries on. like yacc, errors within three tokens
+ * of the last recovery are taken to be fallout from it and not reported.
+ */
+template <typename SINK = NULL_SINK, typename SOURCE = STREAM_SOURCE>
 class Parser {
 public:
-    Parser(std::vector<TOKEN>);
-    void programme();
+    Parser(SOURCE);
+    // true if the programme parsed without errors
+    bool programme();
+
+    const std::vector<DIAGNOSTIC>& diagnostics() const { return errors; }
+    const AST& tree() const { return ast; }
+    const TokenStream& tokenStream() const { return source.stream(); }
+    // writes out what the sink still buffers; false if the parse tree could not all be written
+    bool flushTree() { sink.flush(); return !sink.failed(); }
 
 private:
 
-    std::vector<TOKEN> tokens;
-    size_t index;
-
-    //parse tree vars
-    int depth;
-    int parse_tree_fd = -1;
-    bool next_line=true;
-    const std::string parse_tree_directory = "output";
-    const std::string parse_tree_filename = "parse_tree.txt";
-
-    TOKEN peek();
-    void match(const std::string&);
-    void match(TOKEN_CLASS);
-
-
-    bool drawInStart(const std::string&);
-    bool drawInEnd();
-    void write(const std::string&);
-
-    void programme_1();
-    void type();
-    void argList();
-    void declaration();
-    void stmt();
-    void noIfStmt();
-    void forStmt();
-    void optExpr();
-    void whileStmt();
-    void ifStmt();
-    void elsePart();
-    void compStmt();
-    void stmtList();
-    void returnStmt();
-    void expr();
-    void expr_1();
-    void rvalue();
-    void rvalue_1();
-    void mag();
-    void mag_1();
-    void term();
-    void term_1();
-    void compare();
-    void factor();
-    void identifier();
-    void number();
-};
\ No newline at end of file
+    /*a grammar symbol still to be matched, or the end of `ends` open parse tree nodes*/
+    struct STACK_ENTRY {
+        uint16_t symbol;    // GRAMMAR_SYMBOL, or END_NODES
+        uint32_t ends;
+    };
+    static constexpr uint16_t END_NODES = GRAMMAR_SYMBOL_COUNT;
+    static constexpr uint16_t END_CHECKPOINT = GRAMMAR_SYMBOL_COUNT + 1;
+
+    /*where error recovery unwinds to: a Stmt or TopLevel being parsed*/
+    struct CHECKPOINT {
+        uint32_t stack_size;    // stack.size() with this checkpoint's END_CHECKPOINT on top
+        uint32_t values, marks, saved;
+        bool top_level;
+    };
+    static constexpr size_t RESYNC_TOKENS = 3;
+    static constexpr size_t NEVER = SIZE_MAX;
+
+    SOURCE source;
+    GRAMMAR_SYMBOL lookahead;   // terminal of the source's current token
+    std::vector<STACK_ENTRY> stack;
+
+    //ast vars
+    AST ast;
+    std::vector<uint32_t> values;   // finished nodes still waiting for a parent
+    std::vector<uint32_t> marks;    // values.size() where each open child list starts
+    std::vector<uint32_t> saved;    // tokens remembered by @token
+
+    //expression vars
+    /*operator, or open bracket (TK_LPAREN), waiting for its right operand to be finished*/
+    struct PENDING_OPERATOR {
+        uint32_t token;
+        TOKEN_KIND kind;
+        uint8_t power;
+    };
+    std::vector<PENDING_OPERATOR> operators;
+    std::vector<uint32_t> walk;     // emitExpression()'s stack
+
+    SINK sink;
+
+    //error recovery vars
+    std::vector<DIAGNOSTIC> errors;
+    std::vector<CHECKPOINT> checkpoints;
+    size_t recovered_at = NEVER;     // source.position() where the last recovery stopped skipping
+
+    GRAMMAR_SYMBOL peek();
+    void advance();
+    std::string_view peekLexeme();
+    uint32_t peekLine();
+    void expand(GRAMMAR_SYMBOL nonterminal);
+    void match(GRAMMAR_SYMBOL terminal);
+    void act(GRAMMAR_SYMBOL action);
+    void expression();
+    void reduceOperator();
+    void emitExpression(uint32_t root);
+    uint32_t reduce(NODE_KIND kind, TOKEN_KIND op, uint32_t token, uint32_t count);
+    uint32_t childrenSinceMark();
+    uint32_t popSaved();
+    void syntaxError(GRAMMAR_SYMBOL symbol, std::string message);
+    void skipTokens(bool top_level);
+    void unwindTo(size_t stack_size);
+};
+
+Parser(TokenStream) -> Parser<NULL_SINK, STREAM_SOURCE>;
+
+/*
+ * where each top level item starts: token 0, and after every `::` or closing `}` at brace
+ * depth 0. a cheap token scan, no parse; parsing each slice as a programme gives the same
+ * tree as parsing the whole stream when there are no errors. the last entry is
+ * tokens.size() when the stream ends on such a boundary.
+ */
+std::vector<uint32_t> splitTopLevel(const TokenStream& tokens);
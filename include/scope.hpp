@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ast.hpp"
+#include "lexer.hpp"
+
+/*one declared name: a function, parameter, global or local*/
+struct SYMBOL {
+    uint32_t name;      // symbol table id of the identifier, the same for every declaration of it
+    DATA_TYPE type;
+    uint32_t node;      // declaring AST node: NODE_FUNCTION, NODE_PARAM, or the NODE_IDENTIFIER in a NODE_DECLARATION
+    uint32_t depth;     // scope depth it was declared at, 0 for top level
+};
+
+/*
+ * names in nested scopes. bindings maps a symbol table id straight to the innermost
+ * symbol with that name, so lookup() is one array read; declare() records the binding it
+ * shadows in an undo log and exit() restores those, so leaving a scope costs what the scope
+ * declared and nothing for the names it did not touch. symbols are never removed:
+ * operator[] stays valid for every symbol ever declared.
+ */
+class SCOPE_TABLE {
+public:
+    static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+    void enter();
+    void exit();
+    uint32_t declare(uint32_t name, DATA_TYPE type, uint32_t node);
+    uint32_t lookup(uint32_t name) const {
+        return name < bindings.size() ? bindings[name] : NO_SYMBOL;
+    }
+    // true if name is declared in the innermost scope itself, not just visible in it
+    bool declaredHere(uint32_t name) const {
+        uint32_t symbol = lookup(name);
+        return symbol != NO_SYMBOL && all[symbol].depth == depth();
+    }
+    uint32_t depth() const { return static_cast<uint32_t>(scopes.size()); }
+    const SYMBOL& operator[](uint32_t symbol) const { return all[symbol]; }
+    const std::vector<SYMBOL>& symbols() const { return all; }
+    void reset();
+
+private:
+    /*what a declaration overwrote in bindings*/
+    struct SHADOWED {
+        uint32_t name;
+        uint32_t symbol;
+    };
+    std::vector<uint32_t> bindings;     // symbol table id -> innermost visible symbol
+    std::vector<SHADOWED> undo;
+    std::vector<uint32_t> scopes;       // undo.size() when each open scope was entered
+    std::vector<SYMBOL> all;
+};
+
+/*
+ * the result of bindNames(): every declaration, and for each AST node the symbol it
+ * declares (function, parameter, declared name) or refers to (identifier in an expression,
+ * called function).
+ */
+struct NAME_BINDINGS {
+    SCOPE_TABLE scopes;
+    std::vector<uint32_t> node_symbols;     // by AST node, SCOPE_TABLE::NO_SYMBOL for none
+    std::vector<uint32_t> undeclared;       // identifier and call nodes with no declaration in scope
+    std::vector<uint32_t> redeclared;       // declaring nodes whose name the same scope already declared
+
+    uint32_t symbolOf(uint32_t node) const { return node_symbols[node]; }
+};
+
+/*
+ * resolves the names in tree, whose token indices refer to tokens. top level names are
+ * visible from their declaration on; a function's parameters get a scope of their own and
+ * every block nests another in the one around it.
+ */
+NAME_BINDINGS bindNames(const AST& tree, const TokenStream& tokens);
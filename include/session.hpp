@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "incremental_lexer.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+
+/*
+ * one top level item (a function or a global) with the whitespace and comments after it.
+ * it is lexed and parsed on its own: token offsets and lines count from the start of text,
+ * so nothing in it changes when an edit elsewhere moves it.
+ */
+struct UNIT {
+    std::optional<IncrementalLexer> lexer;  // owns text
+    // where text starts in the document; in a Session, only once units() has settled them, and
+    // until then they are off by the pending shift, which can take them below zero
+    int64_t offset = 0;
+    int64_t line = 1;
+    std::string lex_errors;
+    std::optional<Parser<>> parser;     // views text, so a UNIT is never moved once parsed
+
+    std::string_view text() const { return lexer->text(); }
+    uint32_t tokenCount() const { return parser->tokenStream().size(); }
+    // diagnostic line in the document, 0 for end of file
+    uint32_t documentLine(const DIAGNOSTIC& diagnostic) const {
+        return diagnostic.line ? static_cast<uint32_t>(line + diagnostic.line - 1) : 0;
+    }
+};
+
+/*
+ * a document kept lexed and parsed across edits, for editors. the text is split into
+ * UNITs with splitTopLevel(). an edit inside one unit goes to that unit's IncrementalLexer,
+ * and if the unit is still one top level item that ends cleanly only it is parsed again.
+ * any other edit re-lexes and re-parses the units the edited range touches and splices
+ * them in place of the old ones. the damaged region grows
+ * into the following unit while it does not end cleanly, i.e. while the lexer ran off its
+ * end (open comment or string) or its tokens do not end on a top level boundary (an open
+ * brace), and into the unit before it when it no longer starts with a token, so the units
+ * always match what loading the whole new text would give.
+ *
+ * units after an edit do not have their offset and line updated straight away: one pending
+ * shift covers everything from some unit on, and a later edit only settles the units
+ * between the two edits. typing in one place costs the same however long the file is.
+ *
+ * errors are per unit: recovery never skips from one top level item into the next.
+ * symbol and literal table entries of replaced units are not removed.
+ */
+class Session {
+public:
+    struct EDIT_STATS {
+        size_t units = 0;       // units re-parsed
+        size_t tokens = 0;      // tokens re-lexed
+    };
+
+    bool load(const char* filename);
+    void load(std::string_view text);
+    // replaces length bytes at offset with text
+    EDIT_STATS edit(size_t offset, size_t length, std::string_view text);
+
+    // applies the pending shift, so every unit's offset and line are up to date
+    const std::vector<std::unique_ptr<UNIT>>& units();
+    size_t errorCount() const { return error_count; }
+    size_t size() const { return offsetOf(unit_list.size() - 1) + unit_list.back()->text().size(); }
+
+private:
+    TABLE<SYMBOL_TABLE_ENTRY> symbol_table;
+    TABLE<LITERAL_TABLE_ENTRY> literal_table;
+    std::vector<std::unique_ptr<UNIT>> unit_list;
+    size_t error_count = 0;
+
+    // units from shift_from on are shift_offset bytes and shift_lines lines further on than they say
+    size_t shift_from = SIZE_MAX;
+    int64_t shift_offset = 0;
+    int64_t shift_lines = 0;
+
+    size_t offsetOf(size_t unit) const {
+        int64_t offset = unit_list[unit]->offset + (unit >= shift_from ? shift_offset : 0);
+        assert(offset >= 0);
+        return static_cast<size_t>(offset);
+    }
+    uint32_t lineOf(size_t unit) const {
+        int64_t line = unit_list[unit]->line + (unit >= shift_from ? shift_lines : 0);
+        assert(line >= 1);
+        return static_cast<uint32_t>(line);
+    }
+    // moves units [from, to) by offset bytes and lines lines, back for negative ones
+    void shift(size_t from, size_t to, int64_t offset, int64_t lines);
+    // puts units in place of [first, last], or keeps those if units is empty, and moves everything after by the change
+    void replace(size_t first, size_t last, std::vector<std::unique_ptr<UNIT>> units, int64_t size_change,
+                 int64_t line_change);
+
+    std::vector<std::unique_ptr<UNIT>> build(const std::string& text, size_t offset, uint32_t line,
+                                             bool& clean_start, bool& clean_end);
+    std::unique_ptr<UNIT> parseUnit(std::string text, size_t offset, uint32_t line);
+    // parses unit's tokens, and takes its lex errors, from its lexer
+    void parse(UNIT& unit);
+    size_t unitAt(size_t offset) const;
+    static size_t errorsIn(const UNIT& unit);
+};
+
+/*
+ * urduG++ --serve file.ucc: loads file and answers edit commands on stdin, one per line.
+ *
+ *   edit <offset> <length> <bytes>   followed by <bytes> (at most 1 GiB) bytes of replacement text;
+ *                                    answers ok <units re-parsed> <tokens re-lexed> <errors> <time>us
+ *   errors                           every diagnostic, then a line with a single .
+ *   units                            line offset bytes tokens nodes of each unit, then .
+ *   quit
+ */
+int serve(const char* filename);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * byte-run kernels shared by Scanner() and the lexer.
+ * every kernel looks at p[0, n) and returns the index of the first byte it
+ * stops at, or n when the run reaches the end of the input.
+ */
+struct SCAN_KERNELS {
+    const char* name;
+    size_t (*findSpecial)(const char* p, size_t n);     // first '/' or whitespace byte
+    size_t (*skipWhitespace)(const char* p, size_t n);  // first non-whitespace byte
+    size_t (*findLineEnd)(const char* p, size_t n);     // first '\n'
+    size_t (*findBlockEnd)(const char* p, size_t n);    // first '*' that is followed by '/'
+
+    // character-class runs the lexer DFA loops on
+    size_t (*skipAlnum)(const char* p, size_t n);           // [0-9A-Za-z]*, the I1 loop
+    size_t (*skipIdentifierTail)(const char* p, size_t n);  // [0-9A-Za-z-]*, the I_UND loop
+    size_t (*skipDigits)(const char* p, size_t n);          // [0-9]*, the N1/N_DECIMAL_N/N_EXP_N loops
+    size_t (*skipStringBody)(const char* p, size_t n);      // bytes the SL1 state loops on
+};
+
+// byte-at-a-time reference implementation
+const SCAN_KERNELS& scalarKernels();
+
+// the x86 implementations, so each can be checked against scalar; nullptr when the build has no
+// SSE2 kernels or the running CPU lacks AVX2
+const SCAN_KERNELS* sse2Kernels();
+const SCAN_KERNELS* avx2Kernels();
+
+// widest implementation the running CPU supports (AVX2, SSE2 or scalar), picked once via CPUID
+const SCAN_KERNELS& scanKernels();
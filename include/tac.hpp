@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "ast.hpp"
+#include "lexer.hpp"
+#include "scope.hpp"
+
+enum TAC_OP : uint8_t {
+    TAC_COPY,           // result := left
+    TAC_ADD,            // result := left op right, for this and the rest of the arithmetic and comparisons
+    TAC_SUBTRACT,
+    TAC_MULTIPLY,
+    TAC_DIVIDE,
+    TAC_EQ,
+    TAC_NE,
+    TAC_LT,
+    TAC_GT,
+    TAC_LE,
+    TAC_GE,
+    TAC_LABEL,          // left is the label
+    TAC_JUMP,           // goto label left
+    TAC_JUMP_IF_FALSE,  // if left is zero goto label right
+    TAC_FUNCTION,       // start of function result: left parameters follow as TAC_PARAM, right temporaries
+    TAC_PARAM,          // result is the next parameter
+    TAC_ARG,            // left is the next argument of the TAC_CALL that follows
+    TAC_CALL,           // result := call function left with the right arguments just passed
+    TAC_OUTPUT,         // write left, a value or a string literal
+    TAC_INPUT,          // read result
+    TAC_RETURN,         // return left, or nothing if left is OPERAND_NONE
+    TAC_END,            // end of the current function
+    TAC_OP_COUNT
+};
+
+enum OPERAND_KIND : uint8_t {
+    OPERAND_NONE,
+    OPERAND_TEMP,       // virtual register, numbered from 0 in each function
+    OPERAND_SYMBOL,     // index into NAME_BINDINGS::scopes; depth 0 symbols are globals
+    OPERAND_LITERAL,    // literal table id
+    OPERAND_LABEL,      // numbered across the whole programme; TAC::labels says where each is
+};
+
+/*one quadruple: op, result, left, right, each operand an index whose meaning its kind gives*/
+struct QUAD {
+    TAC_OP op;
+    OPERAND_KIND result_kind, left_kind, right_kind;
+    uint32_t result, left, right;
+};
+
+static_assert(sizeof(QUAD) == 16, "QUAD should stay four words");
+static_assert(std::is_trivially_copyable<QUAD>::value, "QUAD is stored by value in a flat array");
+
+/*
+ * assigning to a symbol, passing an argument and returning convert the value to the declared
+ * type: Adadi and Harf truncate an Ashriya towards zero, saturating, Ashriya widens, Mantiqi
+ * is True for anything but zero. arithmetic is Ashriya if either side is, Adadi otherwise,
+ * and comparisons give Mantiqi. locals are zeroed where they are declared.
+ */
+inline int64_t truncateToAdadi(double value) {
+    if (value != value) return 0;
+    if (value <= -9223372036854775808.0) return INT64_MIN;
+    if (value >= 9223372036854775808.0) return INT64_MAX;
+    return static_cast<int64_t>(value);
+}
+
+LITERAL_TABLE_ENTRY convertTo(DATA_TYPE type, const LITERAL_TABLE_ENTRY& value);
+
+/*
+ * three address code for a whole programme, functions one after another. temporaries
+ * only live within the expression that computes them, so each function's TAC_FUNCTION
+ * says how many it needs; labels[n] is the index of label n's TAC_LABEL, or NO_QUAD once
+ * the optimizer has removed it.
+ */
+struct TAC {
+    static constexpr uint32_t NO_QUAD = UINT32_MAX;
+
+    std::vector<QUAD> code;
+    std::vector<uint32_t> labels;
+};
+
+/*
+ * translates a tree that parsed without errors and whose names all resolved. one walk over
+ * the tree emits straight into code, which is reserved up front from the tree's size.
+ * True and False become literals too, added to literal_table.
+ */
+TAC generateTAC(const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                TABLE<LITERAL_TABLE_ENTRY>& literal_table);
+
+// one line per quad, with symbols by name and literals by value
+std::string tacToString(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                        const TABLE<LITERAL_TABLE_ENTRY>& literals);
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/*
+ * what a token is, beyond its TOKEN_CLASS. every keyword, operator and punctuator has
+ * its own kind so the parser can branch on integers; keywords come first and form the
+ * contiguous range lookupKeyword() hashes.
+ */
+enum TOKEN_KIND : uint8_t {
+    TK_NONE,
+
+    // keywords
+    KW_ASM,
+    KW_WAGARNA,
+    KW_NEW,
+    KW_THIS,
+    KW_AUTO,
+    KW_ENUM,
+    KW_OPERATOR,
+    KW_THROW,
+    KW_MANTIQI,
+    KW_EXPLICIT,
+    KW_PRIVATE,
+    KW_TRUE,
+    KW_BREAK,
+    KW_EXPORT,
+    KW_PROTECTED,
+    KW_TRY,
+    KW_CASE,
+    KW_EXTERN,
+    KW_PUBLIC,
+    KW_TYPEDEF,
+    KW_CATCH,
+    KW_FALSE,
+    KW_REGISTER,
+    KW_TYPEID,
+    KW_HARF,
+    KW_ASHRIYA,
+    KW_TYPENAME,
+    KW_ADADI,
+    KW_CLASS,
+    KW_FOR,
+    KW_WAPAS,
+    KW_UNION,
+    KW_CONST,
+    KW_DOST,
+    KW_SHORT,
+    KW_UNSIGNED,
+    KW_GOTO,
+    KW_SIGNED,
+    KW_USING,
+    KW_CONTINUE,
+    KW_AGAR,
+    KW_SIZEOF,
+    KW_VIRTUAL,
+    KW_DEFAULT,
+    KW_INLINE,
+    KW_STATIC,
+    KW_KHALI,
+    KW_DELETE,
+    KW_VOLATILE,
+    KW_DO,
+    KW_LONG,
+    KW_STRUCT,
+    KW_DOUBLE,
+    KW_MUTABLE,
+    KW_SWITCH,
+    KW_WHILE,
+    KW_NAMESPACE,
+    KW_TEMPLATE,
+    KW_MARQAZI,
+    KW_MATN,
+    KW_OUTPUT,
+    KW_INPUT,
+
+    // operators
+    TK_ASSIGN,
+    TK_PLUS,
+    TK_MINUS,
+    TK_STAR,
+    TK_SLASH,
+    TK_PERCENT,
+    TK_PLUS_ASSIGN,
+    TK_INCREMENT,
+    TK_EQUALS,
+    TK_EQ,
+    TK_NE,
+    TK_LT,
+    TK_GT,
+    TK_LE,
+    TK_GE,
+    TK_LTGT,
+    TK_SHIFT_LEFT,
+    TK_SHIFT_RIGHT,
+    TK_AND,
+    TK_OR,
+
+    // punctuators
+    TK_LPAREN,
+    TK_RPAREN,
+    TK_LBRACE,
+    TK_RBRACE,
+    TK_LBRACKET,
+    TK_RBRACKET,
+    TK_TERMINATOR,
+    TK_COMMA,
+
+    // token classes without a fixed spelling
+    TK_IDENTIFIER,
+    TK_NUMBER,
+    TK_STRING,
+    TK_EOF,
+
+    TOKEN_KIND_COUNT
+};
+
+constexpr int KEYWORD_FIRST = KW_ASM;
+constexpr int KEYWORD_END = TK_ASSIGN;
+constexpr int OPERATOR_FIRST = TK_ASSIGN;
+constexpr int OPERATOR_END = TK_LPAREN;
+constexpr int PUNCTUATOR_FIRST = TK_LPAREN;
+constexpr int PUNCTUATOR_END = TK_IDENTIFIER;
+
+// empty for kinds whose lexeme varies
+constexpr std::string_view TOKEN_KIND_SPELLINGS[TOKEN_KIND_COUNT] = {
+    "",
+    "asm",
+    "Wagarna",
+    "new",
+    "this",
+    "auto",
+    "enum",
+    "operator",
+    "throw",
+    "Mantiqi",
+    "explicit",
+    "private",
+    "True",
+    "break",
+    "export",
+    "protected",
+    "try",
+    "case",
+    "extern",
+    "public",
+    "typedef",
+    "catch",
+    "False",
+    "register",
+    "typeid",
+    "Harf",
+    "Ashriya",
+    "typename",
+    "Adadi",
+    "class",
+    "for",
+    "Wapas",
+    "union",
+    "const",
+    "dost",
+    "short",
+    "unsigned",
+    "goto",
+    "signed",
+    "using",
+    "continue",
+    "Agar",
+    "sizeof",
+    "virtual",
+    "default",
+    "inline",
+    "static",
+    "Khali",
+    "delete",
+    "volatile",
+    "do",
+    "long",
+    "struct",
+    "double",
+    "mutable",
+    "switch",
+    "while",
+    "namespace",
+    "template",
+    "Marqazi",
+    "Matn",
+    "output<-",
+    "input->",
+    ":=",
+    "+",
+    "-",
+    "*",
+    "/",
+    "%",
+    "+=",
+    "++",
+    "=",
+    "==",
+    "!=",
+    "<",
+    ">",
+    "<=",
+    ">=",
+    "<>",
+    "<<",
+    ">>",
+    "&&",
+    "||",
+    "(",
+    ")",
+    "{",
+    "}",
+    "[",
+    "]",
+    "::",
+    ",",
+    "",
+    "",
+    "",
+    "",
+};
+
+constexpr std::string_view tokenKindSpelling(TOKEN_KIND kind) {
+    return TOKEN_KIND_SPELLINGS[kind];
+}
+
+constexpr bool isKeyword(TOKEN_KIND kind) {
+    return kind >= KEYWORD_FIRST && kind < KEYWORD_END;
+}
+
+/*kind of an operator or punctuator lexeme, TK_NONE for anything else*/
+constexpr TOKEN_KIND operatorKind(std::string_view lexeme) {
+    if (lexeme.empty() || lexeme.size() > 2) {
+        return TK_NONE;
+    }
+    char second = lexeme.size() == 2 ? lexeme[1] : '\0';
+    switch (lexeme[0]) {
+        case '(': return second ? TK_NONE : TK_LPAREN;
+        case ')': return second ? TK_NONE : TK_RPAREN;
+        case '{': return second ? TK_NONE : TK_LBRACE;
+        case '}': return second ? TK_NONE : TK_RBRACE;
+        case '[': return second ? TK_NONE : TK_LBRACKET;
+        case ']': return second ? TK_NONE : TK_RBRACKET;
+        case ',': return second ? TK_NONE : TK_COMMA;
+        case '*': return second ? TK_NONE : TK_STAR;
+        case '/': return second ? TK_NONE : TK_SLASH;
+        case '%': return second ? TK_NONE : TK_PERCENT;
+        case '-': return second ? TK_NONE : TK_MINUS;
+        case ':': return second == ':' ? TK_TERMINATOR : second == '=' ? TK_ASSIGN : TK_NONE;
+        case '+': return second == '\0' ? TK_PLUS : second == '=' ? TK_PLUS_ASSIGN : second == '+' ? TK_INCREMENT : TK_NONE;
+        case '=': return second == '\0' ? TK_EQUALS : second == '=' ? TK_EQ : TK_NONE;
+        case '!': return second == '=' ? TK_NE : TK_NONE;
+        case '&': return second == '&' ? TK_AND : TK_NONE;
+        case '|': return second == '|' ? TK_OR : TK_NONE;
+        case '<':
+            switch (second) {
+                case '\0': return TK_LT;
+                case '=': return TK_LE;
+                case '>': return TK_LTGT;
+                case '<': return TK_SHIFT_LEFT;
+                default: return TK_NONE;
+            }
+        case '>':
+            switch (second) {
+                case '\0': return TK_GT;
+                case '=': return TK_GE;
+                case '>': return TK_SHIFT_RIGHT;
+                default: return TK_NONE;
+            }
+        default:
+            return TK_NONE;
+    }
+}
+
+constexpr bool operatorKindsRoundTrip() {
+    for (int k = OPERATOR_FIRST; k < PUNCTUATOR_END; ++k) {
+        if (operatorKind(TOKEN_KIND_SPELLINGS[k]) != k) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(operatorKindsRoundTrip(), "every operator and punctuator spelling must map back to its kind");
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "lexer.hpp"
+
+/*
+ * bounded single-producer/single-consumer queue of TOKENs, for running the lexer and the
+ * parser on separate threads. head and tail only grow; each side keeps a private copy of
+ * the other side's index and rereads the shared one only when that copy says the ring is
+ * full (or empty), so in the steady state the two cores do not bounce cache lines.
+ * a full or empty ring spins briefly and then yields, the input is never dropped.
+ */
+class TOKEN_RING {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit TOKEN_RING(size_t capacity = DEFAULT_CAPACITY) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.resize(size);
+        mask = size - 1;
+    }
+    TOKEN_RING(const TOKEN_RING&) = delete;
+    TOKEN_RING& operator=(const TOKEN_RING&) = delete;
+
+    // producer side
+    void push(const TOKEN& token) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        for (unsigned spins = 0; t - producer_head == slots.size(); ++spins) {
+            producer_head = head.load(std::memory_order_acquire);
+            if (t - producer_head == slots.size()) wait(spins);
+        }
+        slots[t & mask] = token;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    // consumer side
+    TOKEN pop() {
+        size_t h = head.load(std::memory_order_relaxed);
+        for (unsigned spins = 0; h == consumer_tail; ++spins) {
+            consumer_tail = tail.load(std::memory_order_acquire);
+            if (h == consumer_tail) wait(spins);
+        }
+        TOKEN token = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return token;
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+private:
+    static constexpr unsigned SPINS_BEFORE_YIELD = 64;
+
+    std::vector<TOKEN> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> head{0};    // next slot to pop, written by the consumer
+    size_t consumer_tail = 0;
+    alignas(64) std::atomic<size_t> tail{0};    // next slot to push, written by the producer
+    size_t producer_head = 0;
+
+    static void wait(unsigned spins) {
+        if (spins >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+    }
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string_view>
+#include "lexer.hpp"
+#include "token_ring.hpp"
+
+/*
+ * where Parser<SINK, SOURCE> reads its tokens from. a source exposes the lookahead token
+ * (kind, line, lexeme), advance(), position() (tokens consumed so far) and keepPrevious(),
+ * which makes sure the token just consumed is in stream() and returns its index there;
+ * AST nodes refer to tokens by that index.
+ */
+
+/*a fully lexed TokenStream; every token is kept already*/
+class STREAM_SOURCE {
+public:
+    STREAM_SOURCE(TokenStream _tokens) : tokens(std::move(_tokens)) {}
+
+    void start() { index = 0; }
+    bool atEnd() const { return index >= tokens.size(); }
+    TOKEN_KIND kind() const { return tokens.kind(index); }
+    uint32_t line() const { return atEnd() ? 0 : tokens.line(index); }
+    std::string_view lexeme() const { return tokens.lexeme(index); }
+    void advance() { ++index; }
+    size_t position() const { return index; }
+    uint32_t keepPrevious() { return index - 1; }
+    size_t sizeHint() const { return tokens.size(); }
+    const TokenStream& stream() const { return tokens; }
+
+private:
+    TokenStream tokens;
+    size_t index = 0;
+};
+
+/*
+ * tokens popped from a TOKEN_RING as a lexer thread produces them, up to its T_EOF token.
+ * only the tokens the AST refers to are kept, so the rest of the input costs ring
+ * slots rather than memory proportional to the file.
+ */
+class RING_SOURCE {
+public:
+    RING_SOURCE(TOKEN_RING& _ring, std::string_view _text) : ring(&_ring), text(_text), kept(_text) {}
+
+    void start() {
+        current = ring->pop();
+        consumed = 0;
+        kept_at = NOT_KEPT;
+    }
+    bool atEnd() const { return current.t_class == TOKEN_CLASS::T_EOF; }
+    TOKEN_KIND kind() const { return current.t_kind; }
+    uint32_t line() const { return atEnd() ? 0 : current.line_number; }
+    std::string_view lexeme() const {
+        std::string_view spelling = tokenKindSpelling(current.t_kind);
+        return spelling.empty() ? lexemeAt(text, current.t_offset, current.t_length) : spelling;
+    }
+    void advance() {
+        previous = current;
+        current = ring->pop();
+        ++consumed;
+    }
+    size_t position() const { return consumed; }
+    uint32_t keepPrevious() {
+        if (kept_at != consumed) {
+            kept.push_back(previous);
+            kept_at = consumed;
+        }
+        return kept.size() - 1;
+    }
+    size_t sizeHint() const { return 0; }
+    const TokenStream& stream() const { return kept; }
+
+private:
+    static constexpr size_t NOT_KEPT = SIZE_MAX;
+
+    TOKEN_RING* ring;
+    std::string_view text;
+    TokenStream kept;
+    TOKEN current, previous;
+    size_t consumed = 0;            // tokens advanced past
+    size_t kept_at = NOT_KEPT;      // value of consumed when previous was last kept
+};
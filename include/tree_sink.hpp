@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "parse_table.hpp"
+
+/*
+ * parse tree sinks, plugged into Parser<SINK> at compile time. a sink sees a node open
+ * for every nonterminal the parser expands, a leaf for every identifier and number it
+ * matches, and close(n) when n nodes end at the same token. with NULL_SINK the parser
+ * does not even track where nodes end.
+ */
+struct NULL_SINK {
+    static constexpr bool ENABLED = false;
+
+    void open(GRAMMAR_SYMBOL) {}
+    void leaf(GRAMMAR_SYMBOL) {}
+    void close(uint32_t) {}
+    void flush() {}
+    bool failed() const { return false; }
+};
+
+/*
+ * output file with a write buffer; flushed when it fills up, on flush() and on destruction.
+ * if the file cannot be opened or a write fails, the file is closed, everything after is
+ * dropped and failed() is true.
+ */
+class SINK_FILE {
+public:
+    explicit SINK_FILE(const char* filename);
+    ~SINK_FILE();
+    SINK_FILE(const SINK_FILE&) = delete;
+    SINK_FILE& operator=(const SINK_FILE&) = delete;
+
+    void flush();
+    bool failed() const { return fd == -1; }
+
+protected:
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+    std::string buffer;
+
+    void flushIfFull() {
+        if (buffer.size() >= FLUSH_SIZE) flush();
+    }
+
+private:
+    int fd;
+};
+
+/*the indented text tree in output/parse_tree.txt*/
+class TEXT_SINK : public SINK_FILE {
+public:
+    static constexpr bool ENABLED = true;
+
+    explicit TEXT_SINK(const char* filename = "output/parse_tree.txt") : SINK_FILE(filename) {}
+
+    void open(GRAMMAR_SYMBOL symbol);
+    void leaf(GRAMMAR_SYMBOL symbol);
+    void close(uint32_t count);
+
+private:
+    int depth = 0;
+    bool next_line = false;
+
+    void line(const char* name);
+};
+
+/*
+ * output/parse_tree.bin: "UPT1", the number of grammar symbols and their names (each NUL
+ * terminated), then one byte per event: a grammar symbol opens a node (terminals are
+ * leaves and close themselves), CLOSE ends the innermost open node.
+ */
+class BINARY_SINK : public SINK_FILE {
+public:
+    static constexpr bool ENABLED = true;
+    static constexpr uint8_t CLOSE = 0xFF;
+
+    explicit BINARY_SINK(const char* filename = "output/parse_tree.bin");
+
+    void open(GRAMMAR_SYMBOL symbol) {
+        buffer += static_cast<char>(symbol);
+        flushIfFull();
+    }
+    void leaf(GRAMMAR_SYMBOL symbol) { open(symbol); }
+    void close(uint32_t count) {
+        buffer.append(count, static_cast<char>(CLOSE));
+        flushIfFull();
+    }
+};
+
+static_assert(GRAMMAR_SYMBOL_COUNT < BINARY_SINK::CLOSE, "grammar symbols must fit below BINARY_SINK::CLOSE");
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "ast.hpp"
+#include "lexer.hpp"
+#include "scope.hpp"
+#include "tac.hpp"
+
+/*
+ * register bytecode. every operand is a register of the current frame; the type of each
+ * value is known when it is compiled, so registers hold bare int64_t or double and the
+ * opcode says which (Adadi, Harf and Mantiqi are integers, Ashriya is a double).
+ */
+enum OPCODE : uint8_t {
+    OP_MOVE,                // a := b
+    OP_INT_TO_FLOAT,        // a := b converted as convertTo() does
+    OP_FLOAT_TO_INT,
+    OP_INT_TO_BOOL,
+    OP_FLOAT_TO_BOOL,
+    OP_ADD_I,               // a := b op c, wrapping on overflow
+    OP_SUBTRACT_I,
+    OP_MULTIPLY_I,
+    OP_DIVIDE_I,            // stops the programme on division by zero
+    OP_ADD_F,
+    OP_SUBTRACT_F,
+    OP_MULTIPLY_F,
+    OP_DIVIDE_F,
+    OP_EQ_I,                // a := b op c, 0 or 1
+    OP_NE_I,
+    OP_LT_I,
+    OP_GT_I,
+    OP_LE_I,
+    OP_GE_I,
+    OP_EQ_F,
+    OP_NE_F,
+    OP_LT_F,
+    OP_GT_F,
+    OP_LE_F,
+    OP_GE_F,
+    OP_JUMP_UNLESS_EQ_I,    // goto c unless a op b; a comparison and the branch on it in one
+    OP_JUMP_UNLESS_NE_I,
+    OP_JUMP_UNLESS_LT_I,
+    OP_JUMP_UNLESS_GT_I,
+    OP_JUMP_UNLESS_LE_I,
+    OP_JUMP_UNLESS_GE_I,
+    OP_JUMP_UNLESS_EQ_F,
+    OP_JUMP_UNLESS_NE_F,
+    OP_JUMP_UNLESS_LT_F,
+    OP_JUMP_UNLESS_GT_F,
+    OP_JUMP_UNLESS_LE_F,
+    OP_JUMP_UNLESS_GE_F,
+    OP_JUMP,                // goto b
+    OP_JUMP_IF_FALSE,       // goto b if a is 0
+    OP_GET_GLOBAL,          // a := global b
+    OP_SET_GLOBAL,          // global a := b
+    OP_CALL,                // a := function b, whose frame starts at register c with the arguments in place
+    OP_RETURN,              // return a
+    OP_OUTPUT_I,            // write a
+    OP_OUTPUT_F,
+    OP_OUTPUT_B,
+    OP_OUTPUT_C,
+    OP_OUTPUT_S,            // write string a
+    OP_INPUT_I,             // read a
+    OP_INPUT_F,
+    OP_INPUT_B,
+    OP_INPUT_C,
+    OPCODE_COUNT
+};
+
+struct INSTRUCTION {
+    uint32_t op : 8;
+    uint32_t a : 24;
+    uint32_t b;
+    uint32_t c;
+};
+
+static_assert(sizeof(INSTRUCTION) == 12, "INSTRUCTION should stay three words");
+
+union SLOT {
+    int64_t i;
+    double f;
+};
+
+static_assert(std::is_trivially_copyable<SLOT>::value, "frames are copied and cleared as raw memory");
+
+/*
+ * a frame is params, other locals, temporaries, scratch registers, then constants, which
+ * each call copies in from constants. a call's arguments go in the registers just past
+ * the caller's frame, which become the callee's params.
+ */
+struct BYTECODE_FUNCTION {
+    std::string name;
+    DATA_TYPE type;
+    uint32_t params = 0;
+    uint32_t entry = 0;         // index of the first instruction
+    uint32_t frame_size = 0;
+    uint32_t stack_size = 0;    // frame_size and the arguments of the largest call it makes
+    uint32_t constants_at = 0;
+    std::vector<SLOT> constants;
+};
+
+struct BYTECODE {
+    static constexpr uint32_t NO_FUNCTION = UINT32_MAX;
+
+    std::vector<INSTRUCTION> code;
+    std::vector<BYTECODE_FUNCTION> functions;
+    std::vector<std::string> strings;
+    uint32_t globals = 0;
+
+    uint32_t findFunction(std::string_view name) const;
+};
+
+/*
+ * compiles the three address code of a whole programme. returns false, with a message per
+ * problem in errors, for what the interpreter cannot run: Matn variables, calls to things
+ * that are not functions or with the wrong number of arguments.
+ */
+bool compileBytecode(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                     const TABLE<LITERAL_TABLE_ENTRY>& literal_table, BYTECODE& bytecode, std::vector<std::string>& errors);
+
+/*
+ * runs function entry, which takes no parameters, to the end, and returns its result as an
+ * exit status. dispatch is threaded through a table of label addresses (GCC and Clang's
+ * computed goto). output<- and input-> go through buffers of their own on file descriptors
+ * 1 and 0; output is flushed before input is waited for and at the end. runtime errors are
+ * reported on std::cerr and give EXIT_FAILURE.
+ */
+int runBytecode(const BYTECODE& bytecode, uint32_t entry);
@@ -0,0 +1,48 @@
+#include "ast.hpp"
+
+static const char* const NODE_KIND_NAMES[NODE_KIND_COUNT] = {
+    "Programme", "Function", "Param", "Declaration", "Block", "If", "While", "For",
+    "Return", "ExprStmt", "Output", "Input", "Empty", "Assign", "Binary", "Identifier", "Number", "Boolean",
+    "Call", "String", "Error",
+};
+
+const char* nodeKindName(NODE_KIND kind) {
+    return kind < NODE_KIND_COUNT ? NODE_KIND_NAMES[kind] : "?";
+}
+
+uint32_t AST::add(NODE_KIND kind, TOKEN_KIND op, uint32_t token, const uint32_t* children, uint32_t count) {
+    AST_NODE node{kind, op, count, static_cast<uint32_t>(links.size()), token};
+    links.insert(links.end(), children, children + count);
+    nodes.push_back(node);
+    return size() - 1;
+}
+
+void AST::reserve(size_t node_count) {
+    nodes.reserve(node_count);
+    links.reserve(node_count);
+}
+
+void AST::reset() {
+    nodes.clear();
+    links.clear();
+}
+
+void AST::append(const AST& tree, uint32_t token_base, std::vector<uint32_t>& roots) {
+    if (tree.empty()) return;
+    uint32_t node_base = size();
+    uint32_t link_base = static_cast<uint32_t>(links.size());
+    const AST_NODE& root = tree.nodes.back();
+    for (size_t i = 0; i + 1 < tree.nodes.size(); ++i) {
+        AST_NODE node = tree.nodes[i];
+        node.first_child += link_base;
+        node.token += token_base;
+        nodes.push_back(node);
+    }
+    // the root is built last, so its child list is the last run in links
+    for (uint32_t i = 0; i < root.first_child; ++i) {
+        links.push_back(tree.links[i] + node_base);
+    }
+    for (uint32_t i = 0; i < root.child_count; ++i) {
+        roots.push_back(tree.links[root.first_child + i] + node_base);
+    }
+}
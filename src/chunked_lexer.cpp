@@ -0,0 +1,156 @@
+#include "chunked_lexer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+// below this a chunk is not worth a thread
+static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+// chunks per worker, so one slow chunk does not leave the other workers idle
+static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+/*what one range of the source lexes to, with ids local to its own tables*/
+struct CHUNK_RESULT {
+    std::vector<TOKEN> tokens;
+    TABLE<SYMBOL_TABLE_ENTRY> symbols;
+    TABLE<LITERAL_TABLE_ENTRY> literals;
+    std::string diagnostics;
+    size_t newlines = 0;
+    bool clean = true;
+};
+
+static size_t findByte(std::string_view source, size_t from, char c) {
+    if (from >= source.size()) return source.size();
+    const void* hit = memchr(source.data() + from, c, source.size() - from);
+    return hit ? static_cast<const char*>(hit) - source.data() : source.size();
+}
+
+std::vector<size_t> findChunkBoundaries(std::string_view source, size_t chunks) {
+    const size_t n = source.size();
+    std::vector<size_t> bounds{0};
+    size_t i = 0;
+    size_t quote = findByte(source, 0, '"');
+    size_t slash = findByte(source, 0, '/');
+
+    while (bounds.size() < chunks && i < n) {
+        size_t target = std::max(i, bounds.size() * n / chunks);
+        size_t special = std::min(quote, slash);
+
+        // newlines between i and the next '"' or '/' are outside strings and comments
+        if (target < special) {
+            size_t newline = findByte(source.substr(0, special), target, '\n');
+            if (newline < special) {
+                i = newline + 1;
+                if (i < n) bounds.push_back(i);
+                continue;
+            }
+        }
+        if (special == n) break;
+
+        if (special == quote) {
+            i = std::min(n, findByte(source, quote + 1, '"') + 1);
+        } else if (slash + 1 < n && source[slash + 1] == '/') {
+            // the terminating newline stays usable as a boundary
+            i = findByte(source, slash + 2, '\n');
+        } else if (slash + 1 < n && source[slash + 1] == '*') {
+            size_t end = source.find("*/", slash + 2);
+            i = end == std::string_view::npos ? n : end + 2;
+        } else {
+            i = slash + 1;
+        }
+        if (quote < i) quote = findByte(source, i, '"');
+        if (slash < i) slash = findByte(source, i, '/');
+    }
+    bounds.push_back(n);
+    return bounds;
+}
+
+static void lexRange(std::string_view source, size_t begin, size_t end, CHUNK_RESULT& result) {
+    std::string_view text = source.substr(begin, end - begin);
+    std::ostringstream diagnostics;
+    Lexer lex(text, result.symbols, result.literals, diagnostics);
+    while (!lex.isEmpty()) {
+        TOKEN token = lex.getNextToken();
+        if (token.t_class == TOKEN_CLASS::T_EOF)
+            break;
+        result.tokens.push_back(token);
+    }
+    result.diagnostics = diagnostics.str();
+    result.newlines = std::count(text.begin(), text.end(), '\n');
+    result.clean = lex.endedClean();
+}
+
+void lexChunked(std::string_view source, unsigned threads,
+                TABLE<SYMBOL_TABLE_ENTRY>& symbol_table, TABLE<LITERAL_TABLE_ENTRY>& literal_table,
+                TokenStream& tokens, std::ostream& diagnostics) {
+    // the serial loop stops at the first NUL byte, so only lex up to it
+    source = source.substr(0, findByte(source, 0, '\0'));
+
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(size_t(threads) * CHUNKS_PER_THREAD, source.size() / MIN_CHUNK_SIZE));
+    std::vector<size_t> bounds = chunks > 1 ? findChunkBoundaries(source, chunks) : std::vector<size_t>{0, source.size()};
+    size_t count = bounds.size() - 1;
+
+    std::vector<CHUNK_RESULT> results(count);
+    std::atomic<size_t> next_chunk(0);
+    auto worker = [&]() {
+        for (size_t i; (i = next_chunk.fetch_add(1)) < count;) {
+            lexRange(source, bounds[i], bounds[i + 1], results[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < std::min<size_t>(threads, count); ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    size_t total = 0;
+    for (const auto& result : results) {
+        total += result.tokens.size();
+    }
+    tokens.reserve(tokens.size() + total);
+
+    uint32_t base_line = 1;
+    std::vector<int32_t> symbol_ids, literal_ids;
+    for (size_t i = 0; i < count;) {
+        // a chunk that ended inside a token did not start its successor at START; fall back to lexing it with the
+        // chunks after it serially, taking twice as many each time so a long run is not lexed again chunk by chunk
+        size_t last = i;
+        CHUNK_RESULT* result = &results[i];
+        std::unique_ptr<CHUNK_RESULT> merged;
+        for (size_t span = 1; !result->clean && last + 1 < count; span *= 2) {
+            last = std::min(count - 1, last + span);
+            merged = std::make_unique<CHUNK_RESULT>();
+            lexRange(source, bounds[i], bounds[last + 1], *merged);
+            result = merged.get();
+        }
+
+        // local ids are in first-seen order within the chunk, so inserting them in order keeps global ids serial
+        symbol_ids.resize(result->symbols.size());
+        for (uint32_t id = 0; id < symbol_ids.size(); ++id) {
+            symbol_ids[id] = symbol_table.insert(result->symbols.lexeme(id), result->symbols[id]);
+        }
+        literal_ids.resize(result->literals.size());
+        for (uint32_t id = 0; id < literal_ids.size(); ++id) {
+            literal_ids[id] = literal_table.insert(result->literals.lexeme(id), result->literals[id]);
+        }
+
+        for (TOKEN token : result->tokens) {
+            token.t_offset += bounds[i];
+            token.line_number += base_line - 1;
+            if (token.t_class == TOKEN_CLASS::Identifier) {
+                token.t_id = symbol_ids[token.t_id];
+            } else if (token.t_class == TOKEN_CLASS::Number || token.t_class == TOKEN_CLASS::String_Literal) {
+                token.t_id = literal_ids[token.t_id];
+            }
+            tokens.push_back(token);
+        }
+        diagnostics << result->diagnostics;
+        base_line += result->newlines;
+        i = last + 1;
+    }
+    diagnostics.flush();
+}
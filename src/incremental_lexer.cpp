@@ -0,0 +1,102 @@
+#include "incremental_lexer.hpp"
+#include <algorithm>
+
+IncrementalLexer::IncrementalLexer(std::string text, TABLE<SYMBOL_TABLE_ENTRY>& symTable,
+                                   TABLE<LITERAL_TABLE_ENTRY>& litTable)
+    : document(std::move(text)), symbol_table(symTable), literal_table(litTable) {
+    token_stream.setText(document);
+    Lexer lex(document, symbol_table, literal_table, messages);
+    while (!lex.isEmpty()) {
+        TOKEN token = lex.getNextToken();
+        if (token.t_class == TOKEN_CLASS::T_EOF)
+            break;
+        collectErrors(lex_errors, token.t_offset);
+        token_stream.push_back(token);
+    }
+    collectErrors(lex_errors, document.size());
+    ends_clean = lex.endedClean();
+}
+
+void IncrementalLexer::collectErrors(std::vector<LEX_ERROR>& errors, size_t offset) {
+    if (messages.tellp() <= 0)
+        return;
+    std::string reported = messages.str();
+    messages.str("");
+    for (size_t start = 0, end; start < reported.size(); start = end + 1) {
+        end = reported.find('\n', start);
+        if (end == std::string::npos)
+            end = reported.size();
+        errors.push_back({offset, reported.substr(start, end - start)});
+    }
+}
+
+IncrementalLexer::RELEXED IncrementalLexer::edit(size_t offset, size_t length, std::string_view replacement) {
+    offset = std::min(offset, document.size());
+    length = std::min(length, document.size() - offset);
+    int64_t delta = static_cast<int64_t>(replacement.size()) - static_cast<int64_t>(length);
+
+    // the token before the edit may grow into it, so lexing resumes at its start; with none, at the top
+    size_t first = token_stream.tokenAt(offset);
+    bool from_top = first == 0;
+    size_t restart = 0;
+    uint32_t restart_line = 1;
+    if (!from_top) {
+        --first;
+        restart = token_stream.offset(first);
+        restart_line = token_stream.line(first);
+    }
+
+    document.replace(offset, length, replacement);
+    token_stream.setText(document);
+
+    // old tokens that start past the edit, in old offsets; the first one a new token lands on is where they take over
+    size_t old_token = token_stream.tokenAt(offset + length);
+    size_t edit_end = offset + replacement.size();
+    size_t resync = token_stream.size();
+    int64_t line_shift = 0;
+
+    TokenStream relexed(document);
+    std::vector<LEX_ERROR> errors;
+    Lexer lex(std::string_view(document).substr(restart), symbol_table, literal_table, messages);
+    while (!lex.isEmpty()) {
+        TOKEN token = lex.getNextToken();
+        if (token.t_class == TOKEN_CLASS::T_EOF)
+            break;
+        token.t_offset += restart;
+        token.line_number += restart_line - 1;
+        collectErrors(errors, token.t_offset);
+        if (token.t_offset >= edit_end) {
+            // compared as old offset + replacement size against new offset + length, so neither side goes negative
+            while (old_token < token_stream.size() && token_stream.offset(old_token) + replacement.size() < token.t_offset + length)
+                ++old_token;
+            if (old_token < token_stream.size() && token_stream.offset(old_token) + replacement.size() == token.t_offset + length) {
+                resync = old_token;
+                line_shift = static_cast<int64_t>(token.line_number) - token_stream.line(old_token);
+                break;
+            }
+        }
+        relexed.push_back(token);
+    }
+
+    // errors kept at the restart token came before it and were not lexed again; the ones up to
+    // the token lexing stopped at are replaced, and the ones after it only move
+    auto after = [](size_t value, const LEX_ERROR& error) { return value < error.offset; };
+    auto replaced_from = from_top ? lex_errors.begin() : std::upper_bound(lex_errors.begin(), lex_errors.end(), restart, after);
+    auto replaced_to = lex_errors.end();
+    if (resync < token_stream.size()) {
+        replaced_to = std::upper_bound(replaced_from, lex_errors.end(), static_cast<size_t>(token_stream.offset(resync)), after);
+        for (auto error = replaced_to; error != lex_errors.end(); ++error) {
+            error->offset = static_cast<size_t>(static_cast<int64_t>(error->offset) + delta);
+        }
+    } else {
+        collectErrors(errors, document.size());
+        ends_clean = lex.endedClean();
+    }
+    replaced_from = lex_errors.erase(replaced_from, replaced_to);
+    lex_errors.insert(replaced_from, std::make_move_iterator(errors.begin()), std::make_move_iterator(errors.end()));
+
+    RELEXED result{first, resync - first, relexed.size()};
+    token_stream.replace(first, resync, relexed);
+    token_stream.shift(first + relexed.size(), delta, line_shift);
+    return result;
+}
@@ -0,0 +1,86 @@
+#include "interner.hpp"
+#include <cstring>
+
+INTERNER::INTERNER() : slots(64, SLOT{0, 0}) {}
+
+/*FNV-1a with a final avalanche so the low bits used for the slot index are well mixed*/
+uint32_t INTERNER::hash(std::string_view s) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) {
+        h = (h ^ c) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+// index of the slot holding s, or of the empty slot where it would go
+size_t INTERNER::probe(std::string_view s, uint32_t h) const {
+    size_t mask = slots.size() - 1;
+    size_t i = h & mask;
+    while (slots[i].id_plus_one != 0) {
+        if (slots[i].hash == h && strings[slots[i].id_plus_one - 1] == s) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+uint32_t INTERNER::find(std::string_view s) const {
+    const SLOT& slot = slots[probe(s, hash(s))];
+    return slot.id_plus_one == 0 ? NOT_FOUND : slot.id_plus_one - 1;
+}
+
+uint32_t INTERNER::intern(std::string_view s) {
+    uint32_t h = hash(s);
+    size_t i = probe(s, h);
+    if (slots[i].id_plus_one != 0) {
+        return slots[i].id_plus_one - 1;
+    }
+
+    uint32_t id = size();
+    strings.emplace_back(copyToArena(s), s.size());
+    slots[i] = SLOT{h, id + 1};
+    if (strings.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+const char* INTERNER::copyToArena(std::string_view s) {
+    if (s.empty()) {
+        return "";
+    }
+    if (s.size() > arena_left) {
+        // oversized strings get a block of their own so the current block is not wasted
+        size_t block_size = s.size() > ARENA_BLOCK_SIZE / 4 ? s.size() : ARENA_BLOCK_SIZE;
+        blocks.emplace_back(new char[block_size]);
+        if (block_size != ARENA_BLOCK_SIZE) {
+            memcpy(blocks.back().get(), s.data(), s.size());
+            return blocks.back().get();
+        }
+        arena_cursor = blocks.back().get();
+        arena_left = block_size;
+    }
+    char* p = arena_cursor;
+    memcpy(p, s.data(), s.size());
+    arena_cursor += s.size();
+    arena_left -= s.size();
+    return p;
+}
+
+void INTERNER::grow() {
+    std::vector<SLOT> old(slots.size() * 2, SLOT{0, 0});
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const SLOT& slot : old) {
+        if (slot.id_plus_one == 0) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id_plus_one != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
@@ -1,4 +1,8 @@
 #include "lexer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
 
 std::string getStateName(STATE state) {
     switch (state) {
@@ -25,6 +29,7 @@ std::string getStateName(STATE state) {
         case P_COLON: return "P_COLON";
         case P_FINAL: return "P_FINAL";
         case O_FINAL: return "O_FINAL";
+        case O_PAIR: return "O_PAIR";
         case SL1: return "SL1";
         case SL_FINAL: return "SL_FINAL";
         case K_CHECK: return "K_CHECK";
@@ -33,6 +38,11 @@ std::string getStateName(STATE state) {
         case K_INPUT_SUB: return "K_INPUT_SUB";
         case K_INPUT: return "K_INPUT";
         case K_FINAL: return "K_FINAL";
+        case O_SLASH: return "O_SLASH";
+        case C_LINE: return "C_LINE";
+        case C_BLOCK: return "C_BLOCK";
+        case C_BLOCK_STAR: return "C_BLOCK_STAR";
+        case C_END: return "C_END";
         default: return "UNKNOWN_STATE";
     }
 }
@@ -53,30 +63,147 @@ std::string tokenClassToString(TOKEN_CLASS token) {
 std::string dataTypeToString(DATA_TYPE type) {
     switch (type) {
         case T_DEFAULT: return "T_DEFAULT";
+        case T_ADADI: return "Adadi";
+        case T_ASHRIYA: return "Ashriya";
+        case T_HARF: return "Harf";
+        case T_MATN: return "Matn";
+        case T_MANTIQI: return "Mantiqi";
         default: return "Unknown";
     }
 }
 
-TOKEN::TOKEN(ssize_t id, const std::optional<std::string>& lexeme, TOKEN_CLASS tclass, int line, int column)
-    : t_id(id), t_lexeme(lexeme), t_class(tclass), line_number(line), column_number(column) {}
+DATA_TYPE dataTypeOf(TOKEN_KIND type_keyword) {
+    switch (type_keyword) {
+        case KW_ADADI: return T_ADADI;
+        case KW_ASHRIYA: return T_ASHRIYA;
+        case KW_HARF: return T_HARF;
+        case KW_MATN: return T_MATN;
+        case KW_MANTIQI: return T_MANTIQI;
+        default: return T_DEFAULT;
+    }
+}
+
+TOKEN::TOKEN(TOKEN_CLASS tclass, int32_t id, size_t offset, size_t length, uint32_t line, TOKEN_KIND kind)
+    : t_class(tclass), t_kind(kind), t_length(static_cast<uint16_t>(length < 0xFFFF ? length : 0xFFFF)),
+      t_id(id), t_offset(static_cast<uint32_t>(offset)), line_number(line) {}
+
+TokenStream::TokenStream(std::string_view _source) : source(_source) {}
+
+void TokenStream::push_back(const TOKEN& token) {
+    classes.push_back(token.t_class);
+    kinds.push_back(token.t_kind);
+    ids.push_back(token.t_id);
+    offsets.push_back(token.t_offset);
+    lengths.push_back(token.t_length);
+    lines.push_back(token.line_number);
+}
+
+void TokenStream::reserve(size_t count) {
+    classes.reserve(count);
+    kinds.reserve(count);
+    ids.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+    lines.reserve(count);
+}
+
+TOKEN TokenStream::operator[](size_t i) const {
+    TOKEN token;
+    token.t_class = classes[i];
+    token.t_kind = kinds[i];
+    token.t_length = lengths[i];
+    token.t_id = ids[i];
+    token.t_offset = offsets[i];
+    token.line_number = lines[i];
+    return token;
+}
+
+template <typename T>
+static void replaceRange(std::vector<T>& target, size_t first, size_t last, const std::vector<T>& replacement) {
+    size_t common = std::min(last - first, replacement.size());
+    std::copy(replacement.begin(), replacement.begin() + common, target.begin() + first);
+    if (common < last - first) {
+        target.erase(target.begin() + first + common, target.begin() + last);
+    } else {
+        target.insert(target.begin() + last, replacement.begin() + common, replacement.end());
+    }
+}
+
+void TokenStream::replace(size_t first, size_t last, const TokenStream& replacement) {
+    replaceRange(classes, first, last, replacement.classes);
+    replaceRange(kinds, first, last, replacement.kinds);
+    replaceRange(ids, first, last, replacement.ids);
+    replaceRange(offsets, first, last, replacement.offsets);
+    replaceRange(lengths, first, last, replacement.lengths);
+    replaceRange(lines, first, last, replacement.lines);
+}
+
+void TokenStream::shift(size_t from, int64_t offset, int64_t line_count) {
+    if (from >= size())
+        return;
+    // offsets and lines only grow along the stream, so the first token is the one that could go below zero
+    assert(offsets[from] + offset >= 0 && lines[from] + line_count >= 1);
+    for (size_t i = from; i < size(); ++i) {
+        offsets[i] = static_cast<uint32_t>(offsets[i] + offset);
+        lines[i] = static_cast<uint32_t>(lines[i] + line_count);
+    }
+}
+
+size_t TokenStream::tokenAt(size_t offset) const {
+    return std::lower_bound(offsets.begin(), offsets.end(), offset) - offsets.begin();
+}
 
-std::string TOKEN::toString() const {
-    return "<" + (t_id == -1 ? "" : std::to_string(t_id) + ", ") + 
-           (t_lexeme.has_value() ? t_lexeme.value() + ", " : "") + tokenClassToString(t_class) + ">";
+std::string_view TokenStream::lexeme(size_t i) const {
+    std::string_view spelling = tokenKindSpelling(kinds[i]);
+    if (!spelling.empty()) {
+        return spelling;
+    }
+    return lexemeAt(source, offsets[i], lengths[i]);
 }
 
-SYMBOL_TABLE_ENTRY::SYMBOL_TABLE_ENTRY(TOKEN_CLASS _class, const std::string& _lexeme, DATA_TYPE _datatype, size_t _memory_location)
-    : token_class(_class), lexeme(_lexeme), datatype(_datatype), memory_location(_memory_location) {}
+std::string TokenStream::toString(size_t i) const {
+    bool table_entry = classes[i] == Identifier || classes[i] == Number || classes[i] == String_Literal;
+    return "<" + (table_entry ? std::to_string(ids[i]) + ", " : std::string(lexeme(i)) + ", ") + tokenClassToString(classes[i]) + ">";
+}
 
-std::string SYMBOL_TABLE_ENTRY::toString() const {
-    return lexeme + ", " + tokenClassToString(token_class) + ", " + dataTypeToString(datatype);
+SYMBOL_TABLE_ENTRY::SYMBOL_TABLE_ENTRY(TOKEN_CLASS _class, DATA_TYPE _datatype, size_t _memory_location)
+    : token_class(_class), datatype(_datatype), memory_location(_memory_location) {}
+
+std::string SYMBOL_TABLE_ENTRY::toString(std::string_view lexeme) const {
+    return std::string(lexeme) + ", " + tokenClassToString(token_class) + ", " + dataTypeToString(datatype);
 }
 
-LITERAL_TABLE_ENTRY::LITERAL_TABLE_ENTRY(const std::string& _value, DATA_TYPE _datatype)
-    : value(_value), datatype(_datatype) {}
+LITERAL_TABLE_ENTRY::LITERAL_TABLE_ENTRY(DATA_TYPE _datatype)
+    : datatype(_datatype), integer(0) {}
+
+LITERAL_TABLE_ENTRY::LITERAL_TABLE_ENTRY(int64_t value)
+    : datatype(T_ADADI), integer(value) {}
+
+LITERAL_TABLE_ENTRY::LITERAL_TABLE_ENTRY(double value)
+    : datatype(T_ASHRIYA), decimal(value) {}
+
+LITERAL_TABLE_ENTRY::LITERAL_TABLE_ENTRY(bool value)
+    : datatype(T_MANTIQI), integer(value) {}
+
+std::string LITERAL_TABLE_ENTRY::toString(std::string_view value) const {
+    if (datatype == T_ADADI || datatype == T_HARF) {
+        return std::to_string(integer) + ", " + dataTypeToString(datatype);
+    }
+    if (datatype == T_ASHRIYA) {
+        char digits[32];
+        return std::string(digits, std::to_chars(digits, digits + sizeof(digits), decimal).ptr) + ", " + dataTypeToString(datatype);
+    }
+    if (datatype == T_MANTIQI) {
+        return std::string(integer ? "True" : "False") + ", " + dataTypeToString(datatype);
+    }
+    return std::string(value) + ", " + dataTypeToString(datatype);
+}
 
-std::string LITERAL_TABLE_ENTRY::toString() const {
-    return value + ", " + dataTypeToString(datatype);
+std::string_view numberKey(const LITERAL_TABLE_ENTRY& number, char (&key)[9]) {
+    // a string literal's key starts with '"', so the type byte keeps the two kinds apart
+    key[0] = static_cast<char>(number.datatype);
+    memcpy(key + 1, &number.integer, 8);
+    return std::string_view(key, sizeof(key));
 }
 
 template <typename T>
@@ -88,17 +215,15 @@ bool TABLE<T>::writeToFile(const std::string& filename) const {
         return false;
     }
 
-    int i=0;
     std::string buffer;
-    for(const auto& e : entries) { 
-        buffer = std::to_string(i) + "\t" + e.toString() + "\n";
+    for(uint32_t i = 0; i < entries.size(); ++i) { 
+        buffer = std::to_string(i) + "\t" + entries[i].toString(names.get(i)) + "\n";
         ssize_t bytes_written = write(fd, buffer.c_str(), buffer.size());
         if (bytes_written == -1) {
             std::cerr << "TABLE:writeToFile() unable to write to file\n";
             close(fd);
             return false;
         }
-        ++i;
     }
     close(fd);
 
@@ -109,61 +234,184 @@ bool TABLE<T>::writeToFile(const std::string& filename) const {
 template class TABLE<SYMBOL_TABLE_ENTRY>;
 template class TABLE<LITERAL_TABLE_ENTRY>;
 
-// Valid characters for Transitions class
-const std::set<char> Transitions::valid_chars {
-    '(', ')', '{', '}', '[', ']', ':', '<', '>', '=', 
-    '+', '-', '!', '|', '%', '&', '*', '/', '"'
-};
-
-STATE Transitions::operator[](char character) {
-    if (transitions.find(character) == transitions.end()) {
-        for (auto& f : transition_functions) {
-            if (f.first(character)) {
-                return f.second;
-            }
-        }
-        return error_state;
-    } 
-    return transitions[character];
-}
+// character classes of the "C" locale, usable while building the table at compile time
+static constexpr bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static constexpr bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static constexpr bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
 
-STATE Transitions::operator[](const std::string& keyword) {
-    if (keyword_transitions.find(keyword) == keyword_transitions.end()) {
-        return error_state;
+static constexpr bool isValidCharacter(char c) {
+    switch (c) {
+        case '(': case ')': case '{': case '}': case '[': case ']': case ',': case ':': case '<': case '>': case '=':
+        case '+': case '-': case '!': case '|': case '%': case '&': case '*': case '/': case '"':
+            return true;
+        default:
+            return isDigit(c) || c == __EOF__ || isAlpha(c) || isSpace(c);
     }
-    return keyword_transitions[keyword];
 }
 
-STATE& Transitions::operator()(char character) {
-    return transitions[character];
-}
+/*single DFA step; explicit characters are checked before the character classes*/
+static constexpr STATE computeTransition(STATE state, char c) {
+    switch (state) {
+        case STATE::START:
+            switch (c) {
+                case '_': return STATE::I_UND;
+                case '[': case ']': case '(': case ')': case '{': case '}': case ',': return STATE::P_FINAL;
+                case ':': return STATE::P_COLON;
+                case '<': return STATE::O_LT;
+                case '>': return STATE::O_GT;
+                case '=': return STATE::O_ET;
+                case '+': return STATE::O_ADD;
+                case '-': return STATE::O_SUBTRACT;
+                case '!': return STATE::O_NOT;
+                case '|': return STATE::O_OR;
+                case '&': return STATE::O_AND;
+                case '%': case '*': return STATE::O_FINAL;
+                case '/': return STATE::O_SLASH;
+                case '"': return STATE::SL1;
+            }
+            if (isDigit(c)) return STATE::N1;
+            if (isSpace(c)) return STATE::P_FINAL;
+            if (isAlpha(c)) return STATE::I1;
+            break;
 
-STATE& Transitions::operator()(const std::string& keyword) {
-    return keyword_transitions[keyword];
-}
+        case STATE::SL1:
+            if (c == '"') return STATE::SL_FINAL;
+            if (static_cast<signed char>(c) >= 32 || c == '\t' || c == '\n' || c == '\r') return STATE::SL1;
+            break;
+
+        case STATE::N1:
+            if (c == '.') return STATE::N_DECIMAL;
+            if (c == 'E') return STATE::N_EXP;
+            if (isDigit(c)) return STATE::N1;
+            if (isValidCharacter(c)) return STATE::N_FINAL;
+            break;
+        case STATE::N_DECIMAL:
+            if (isDigit(c)) return STATE::N_DECIMAL_N;
+            break;
+        case STATE::N_DECIMAL_N:
+            if (c == 'E') return STATE::N_EXP;
+            if (isDigit(c)) return STATE::N_DECIMAL_N;
+            if (isValidCharacter(c)) return STATE::N_FINAL;
+            break;
+        case STATE::N_EXP:
+            if (c == '+' || c == '-') return STATE::N_EXP_ADD_SUB;
+            if (isDigit(c)) return STATE::N_EXP_N;
+            break;
+        case STATE::N_EXP_ADD_SUB:
+            if (isDigit(c)) return STATE::N_EXP_N;
+            break;
+        case STATE::N_EXP_N:
+            if (isDigit(c)) return STATE::N_EXP_N;
+            if (isValidCharacter(c)) return STATE::N_FINAL;
+            break;
+
+        case STATE::I_UND:
+            if (c == '-' || isDigit(c) || isAlpha(c)) return STATE::I_UND;
+            if (isValidCharacter(c)) return STATE::I_FINAL;
+            break;
+        case STATE::I1:
+            if (c == '_') return STATE::I_UND;
+            if (isDigit(c) || isAlpha(c)) return STATE::I1;
+            if (isValidCharacter(c)) return STATE::K_CHECK;
+            break;
 
-STATE& Transitions::operator()(const std::function<bool(char)> func) {
-    transition_functions.push_back(std::pair<std::function<bool(char)>, STATE>(func, STATE::ERROR_STATE));
-    return transition_functions.back().second;
-}
+        case STATE::P_COLON:
+            if (c == '=') return STATE::O_PAIR;
+            if (c == ':') return STATE::P_FINAL;
+            break;
+        case STATE::O_LT:
+            if (c == '=' || c == '<' || c == '>') return STATE::O_PAIR;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::O_GT:
+            if (c == '=' || c == '>') return STATE::O_PAIR;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::O_ET:
+            if (c == '=') return STATE::O_PAIR;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::O_ADD:
+            if (c == '=' || c == '+') return STATE::O_PAIR;
+            if (isDigit(c)) return STATE::N1;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::O_SUBTRACT:
+            if (isDigit(c)) return STATE::N1;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::O_NOT:
+            if (c == '=') return STATE::O_PAIR;
+            break;
+        case STATE::O_OR:
+            if (c == '|') return STATE::O_PAIR;
+            break;
+        case STATE::O_AND:
+            if (c == '&') return STATE::O_PAIR;
+            break;
+
+        // comments
+        case STATE::O_SLASH:
+            if (c == '/') return STATE::C_LINE;
+            if (c == '*') return STATE::C_BLOCK;
+            if (isValidCharacter(c)) return STATE::O_FINAL;
+            break;
+        case STATE::C_LINE:
+            if (c == '\n' || c == __EOF__) return STATE::C_END;
+            return STATE::C_LINE;
+        case STATE::C_BLOCK:
+            if (c == '*') return STATE::C_BLOCK_STAR;
+            if (c == __EOF__) break;
+            return STATE::C_BLOCK;
+        case STATE::C_BLOCK_STAR:
+            if (c == '/') return STATE::C_END;
+            if (c == '*') return STATE::C_BLOCK_STAR;
+            if (c == __EOF__) break;
+            return STATE::C_BLOCK;
+
+        // keywords
+        case STATE::K_INPUT:
+            if (c == '-') return STATE::K_INPUT_SUB;
+            break;
+        case STATE::K_INPUT_SUB:
+            if (c == '>') return STATE::K_FINAL;
+            break;
+        case STATE::K_OUTPUT:
+            if (c == '<') return STATE::K_OUTPUT_LT;
+            break;
+        case STATE::K_OUTPUT_LT:
+            if (c == '-') return STATE::K_FINAL;
+            break;
 
-bool Transitions::isValidCharacter(char c) {
-    return isdigit(c) || c == __EOF__ || isalpha(c) || isspace(c) || valid_chars.count(c) > 0;
+        default:
+            break;
+    }
+    return STATE::ERROR_STATE;
 }
 
-Transitions& TRANSITION_TABLE::operator[](STATE state) {
-    return table[state];
+static constexpr DFA_TABLE buildTransitionTable() {
+    DFA_TABLE table{};
+    for (int s = 0; s < STATE_COUNT; ++s) {
+        for (int c = 0; c < 256; ++c) {
+            table.next[s][c] = computeTransition(static_cast<STATE>(s), static_cast<char>(c));
+        }
+    }
+    return table;
 }
 
-bool TRANSITION_TABLE::isFinal(STATE s) {
-    return final_states.count(s) > 0;
-}
+constexpr DFA_TABLE TRANSITION_TABLE::dfa = buildTransitionTable();
 
-bool TRANSITION_TABLE::advance(STATE previous_state, STATE new_state) {
-    if (!isFinal(new_state)) {
-        return true;
+STATE TRANSITION_TABLE::next(STATE state, std::string_view keyword) {
+    if (state != STATE::K_CHECK) {
+        return STATE::ERROR_STATE;
+    }
+    if (keyword == "output") {
+        return STATE::K_OUTPUT;
+    }
+    if (keyword == "input") {
+        return STATE::K_INPUT;
     }
-    return not_advance.count(previous_state) == 0;
+    return STATE::ERROR_STATE;
 }
 
 TOKEN_CLASS TRANSITION_TABLE::getTokenClass(STATE s) {
@@ -171,6 +419,7 @@ TOKEN_CLASS TRANSITION_TABLE::getTokenClass(STATE s) {
         case STATE::N_FINAL:
             return TOKEN_CLASS::Number;     
         case STATE::O_FINAL:
+        case STATE::O_PAIR:
             return TOKEN_CLASS::Operator;    
         case STATE::P_FINAL:
             return TOKEN_CLASS::Punctuation;  
@@ -185,8 +434,7 @@ TOKEN_CLASS TRANSITION_TABLE::getTokenClass(STATE s) {
     }
 }
 
-BUFFER::BUFFER(const char* filename)
-    : in_file_descriptor(-1), buffer_in_use(0), bp(0), fp(0), current_buffer_size(0) {
+BUFFER::BUFFER(const char* filename) {
     if (filename) {
         if (!setFile(filename)) {
             std::cerr << "Error opening file: " << filename << "\n";
@@ -195,185 +443,152 @@ BUFFER::BUFFER(const char* filename)
 }
 
 BUFFER::~BUFFER() {
-    if (in_file_descriptor >= 0) {
-        close(in_file_descriptor);
-    }
+    release();
 }
 
-bool BUFFER::loadBuffer() {
-    if (!isDescriptorSet()) {
-        std::cerr << "FD for input buffer not set\n";
+void BUFFER::release() {
+    if (mapped) {
+        munmap(const_cast<char*>(source), source_size);
+    }
+    source = nullptr;
+    source_size = 0;
+    mapped = false;
+    streamed.clear();
+    bp = fp = 0;
+    line = column = 1;
+}
+
+bool BUFFER::readStream(int fd) {
+    const size_t chunk_size = 1 << 16;
+    ssize_t bytes_read;
+    do {
+        size_t used = streamed.size();
+        streamed.resize(used + chunk_size);
+        bytes_read = read(fd, &streamed[used], chunk_size);
+        streamed.resize(used + (bytes_read > 0 ? bytes_read : 0));
+    } while (bytes_read > 0);
+
+    if (bytes_read == -1) {
+        std::cerr << "unable to load buffer\n";
         return false;
     }
-    bool last_size_zero = current_buffer_size == 0;
+    source = streamed.data();
+    source_size = streamed.size();
+    return true;
+}
 
-    current_buffer_size = read(in_file_descriptor, buffer[1-buffer_in_use], BUFFER_SIZE);
-    if (current_buffer_size == -1) {
-        std::cerr << "unable to load buffer\n";
+bool BUFFER::setFile(const char* filename) {
+    release();
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
         return false;
     }
 
-    buffer_in_use = 1 - buffer_in_use; // Swap buffers (0,1)
-    fp = 0;
-    
-    return current_buffer_size > 0;
+    struct stat info;
+    bool loaded = false;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+            source = static_cast<const char*>(map);
+            source_size = info.st_size;
+            mapped = loaded = true;
+        }
+    }
+    if (!loaded) {
+        // pipes, character devices and empty files
+        loaded = readStream(fd);
+    }
+    close(fd);
+    return loaded;
 }
 
-bool BUFFER::setFile(const char* filename) {
-    in_file_descriptor = open(filename, O_RDONLY);
-    return in_file_descriptor != -1 && loadBuffer();
+void BUFFER::setView(std::string_view text) {
+    release();
+    source = text.data();
+    source_size = text.size();
 }
 
-bool BUFFER::isDescriptorSet() {
-    return in_file_descriptor >= 0;
+bool BUFFER::isLoaded() const {
+    return source != nullptr;
 }
 
-char BUFFER::peekNextCharacter() {
-    return fp >= current_buffer_size ? __EOF__ : buffer[buffer_in_use][fp];
+char BUFFER::peekNextCharacter() const {
+    return fp < source_size ? source[fp] : __EOF__;
 }
 
-bool BUFFER::advance() {
-    if (fp >= current_buffer_size) {
-        return false;
-    }
-    current_lexeme_size++;
+const char* BUFFER::data() const {
+    return source;
+}
 
-    if (fp >= current_buffer_size-1) {
-        if (current_buffer_size < BUFFER_SIZE) {
-            fp = current_buffer_size;
-            return true;
-        }
-        return loadBuffer();
-    }
-    fp++;
+size_t BUFFER::size() const {
+    return source_size;
+}
+
+size_t BUFFER::lexemeStart() const {
+    return bp;
+}
 
-    if (current_lexeme_size >= BUFFER_SIZE) {
-        std::cerr << "FATAL ERROR: lexeme buffer overflow" << std::endl;
-        exit(EXIT_FAILURE);
+std::string_view BUFFER::remaining() const {
+    return std::string_view(source + fp, source_size - fp);
+}
+
+void BUFFER::skip(size_t count) {
+    const char* begin = source + fp;
+    const char* end = begin + count;
+    for (const char* nl = begin; (nl = static_cast<const char*>(memchr(nl, '\n', end - nl))) != nullptr; ++nl) {
+        ++line;
+        column = 1;
+        begin = nl + 1;
     }
-    return true;
+    column += end - begin;
+    fp += count;
 }
 
-bool BUFFER::advanceBp() {
-    if (current_lexeme_size == 0) 
+bool BUFFER::advance() {
+    if (fp >= source_size) {
         return false;
-    bp = (++bp) % BUFFER_SIZE;
-    --current_lexeme_size;
+    }
+    if (source[fp++] == '\n') {
+        ++line;
+        column = 1;
+    } else {
+        ++column;
+    }
     return true;
 }
 
-std::string BUFFER::peekLexeme() {
-    if (bp == fp) return "";
-    std::string lexeme;
-    int t_bp = bp;
-    if (bp + current_lexeme_size >= BUFFER_SIZE) {  // lexeme divided into 2 buffers
-        lexeme += std::string(buffer[1-buffer_in_use] + bp, buffer[1-buffer_in_use]+BUFFER_SIZE);
-        t_bp = 0;
-    }
-    lexeme += std::string(buffer[buffer_in_use]+t_bp, buffer[buffer_in_use] + fp);
-    
+std::string_view BUFFER::peekLexeme() const {
+    return std::string_view(source + bp, fp - bp);
+}
+
+std::string_view BUFFER::popLexeme() {
+    std::string_view lexeme = peekLexeme();
+    dropLexeme();
     return lexeme;
 }
 
-std::string BUFFER::popLexeme() {
-    std::string lexeme = BUFFER::peekLexeme();
+void BUFFER::dropLexeme() {
     bp = fp;
-    current_lexeme_size = 0;
-    return lexeme;
 }
 
-Lexer::Lexer(const char* filename, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable, std::unordered_set<std::string>& kw)
-    : symbol_table(symTable), literal_table(litTable), keywords(kw) {
-    loadTransitions();
-    buffer.setFile(filename);
-}
-
-bool Lexer::loadTransitions() {
-    transition_table[STATE::START]([](char c) { return isdigit(c); }) = STATE::N1;
-    transition_table[STATE::START]([](char c) { return isspace(c); }) = STATE::P_FINAL;
-    transition_table[STATE::START]('_') = STATE::I_UND;
-    transition_table[STATE::START]([](char c) { return isalpha(c); }) = STATE::I1;
-    transition_table[STATE::START]('[') = STATE::P_FINAL;
-    transition_table[STATE::START](']') = STATE::P_FINAL;
-    transition_table[STATE::START]('(') = STATE::P_FINAL;
-    transition_table[STATE::START](')') = STATE::P_FINAL;
-    transition_table[STATE::START]('{') = STATE::P_FINAL;
-    transition_table[STATE::START]('}') = STATE::P_FINAL;
-    transition_table[STATE::START](':') = STATE::P_COLON;
-    transition_table[STATE::START]('<') = STATE::O_LT;
-    transition_table[STATE::START]('>') = STATE::O_GT;
-    transition_table[STATE::START]('=') = STATE::O_ET;
-    transition_table[STATE::START]('+') = STATE::O_ADD;
-    transition_table[STATE::START]('-') = STATE::O_SUBTRACT;
-    transition_table[STATE::START]('!') = STATE::O_NOT;
-    transition_table[STATE::START]('|') = STATE::O_OR;
-    transition_table[STATE::START]('%') = STATE::O_FINAL;
-    transition_table[STATE::START]('&') = STATE::O_AND;
-    transition_table[STATE::START]('*') = STATE::O_FINAL;
-    transition_table[STATE::START]('/') = STATE::O_FINAL;
-
-    transition_table[STATE::START]('"') = STATE::SL1;
-    transition_table[STATE::SL1]([](char c) { return (c >= 32 || c == '\t' || c == '\n' || c == '\r'); }) = STATE::SL1;
-    transition_table[STATE::SL1]('"') = STATE::SL_FINAL;
-
-    transition_table[STATE::N1]([](char c) { return isdigit(c); }) = STATE::N1;
-    transition_table[STATE::N1]('.') = STATE::N_DECIMAL;
-    transition_table[STATE::N1]('E') = STATE::N_EXP;
-
-    transition_table[STATE::N_DECIMAL]([](char c) { return isdigit(c); }) = STATE::N_DECIMAL_N;
-    transition_table[STATE::N_DECIMAL_N]([](char c) { return isdigit(c); }) = STATE::N_DECIMAL_N;
-    transition_table[STATE::N_DECIMAL_N]('E') = STATE::N_EXP;
-
-    transition_table[STATE::N_EXP]([](char c) { return isdigit(c); }) = STATE::N_EXP_N;
-    transition_table[STATE::N_EXP]('+') = STATE::N_EXP_ADD_SUB;
-    transition_table[STATE::N_EXP]('-') = STATE::N_EXP_ADD_SUB;
-    transition_table[STATE::N_EXP_ADD_SUB]([](char c) { return isdigit(c); }) = N_EXP_N;
-    transition_table[STATE::N_EXP_N]([](char c) { return isdigit(c); }) = STATE::N_EXP_N;
-
-    transition_table[STATE::I_UND]([](char c) { return isdigit(c); }) = STATE::I_UND;
-    transition_table[STATE::I_UND]([](char c) { return isalpha(c); }) = STATE::I_UND;
-    transition_table[STATE::I_UND]('-') = STATE::I_UND;
-    transition_table[STATE::I1]([](char c) { return isdigit(c); }) = STATE::I1;
-    transition_table[STATE::I1]([](char c) { return isalpha(c); }) = STATE::I1;
-    transition_table[STATE::I1]('_') = STATE::I_UND;
-
-    transition_table[STATE::P_COLON]('=') = STATE::O_FINAL;
-    transition_table[STATE::P_COLON](':') = STATE::P_FINAL;
-    transition_table[STATE::O_LT]('=') = STATE::O_FINAL;
-    transition_table[STATE::O_LT]('<') = STATE::O_FINAL;
-    transition_table[STATE::O_LT]('>') = STATE::O_FINAL;
-    transition_table[STATE::O_GT]('=') = STATE::O_FINAL;
-    transition_table[STATE::O_GT]('>') = STATE::O_FINAL;
-    transition_table[STATE::O_ET]('=') = STATE::O_FINAL;
-    transition_table[STATE::O_ADD]('=') = STATE::O_FINAL;
-    transition_table[STATE::O_ADD]('+') = STATE::O_FINAL;
-    transition_table[STATE::O_ADD]([](char c) {return isdigit(c);}) = STATE::N1;
-    transition_table[STATE::O_SUBTRACT]([](char c) {return isdigit(c);}) = STATE::N1;
-    transition_table[STATE::O_NOT]('=') = STATE::O_FINAL;
-    transition_table[STATE::O_OR]('|') = STATE::O_FINAL;
-    transition_table[STATE::O_AND]('&') = STATE::O_FINAL;
-
-    // others
-    transition_table[STATE::N1]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::N_FINAL;
-    transition_table[STATE::N_DECIMAL_N]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::N_FINAL;
-    transition_table[STATE::N_EXP_N]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::N_FINAL;
-    transition_table[STATE::I1]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::K_CHECK;
-    transition_table[STATE::I_UND]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::I_FINAL;
-    transition_table[STATE::O_LT]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::O_FINAL;
-    transition_table[STATE::O_GT]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::O_FINAL;
-    transition_table[STATE::O_ET]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::O_FINAL;
-    transition_table[STATE::O_ADD]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::O_FINAL;
-    transition_table[STATE::O_SUBTRACT]([](char c) { return Transitions::isValidCharacter(c); }) = STATE::O_FINAL;
-
-    // keywords
-    transition_table[STATE::K_CHECK]("output") = STATE::K_OUTPUT;
-    transition_table[STATE::K_CHECK]("input") = STATE::K_INPUT;
-    transition_table[STATE::K_INPUT]('-') = STATE::K_INPUT_SUB;
-    transition_table[STATE::K_INPUT_SUB]('>') = K_FINAL;
-    transition_table[STATE::K_OUTPUT]('<') = K_OUTPUT_LT;
-    transition_table[STATE::K_OUTPUT_LT]('-') = K_FINAL;
+int BUFFER::getLine() const {
+    return line;
+}
 
-    return true;
+int BUFFER::getColumn() const {
+    return column;
+}
+
+Lexer::Lexer(const char* filename, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable)
+    : symbol_table(symTable), literal_table(litTable), kernels(scanKernels()), diagnostics(std::cout) {
+    loaded = buffer.setFile(filename);
+}
+
+Lexer::Lexer(std::string_view text, TABLE<SYMBOL_TABLE_ENTRY>& symTable, TABLE<LITERAL_TABLE_ENTRY>& litTable, std::ostream& diag)
+    : symbol_table(symTable), literal_table(litTable), kernels(scanKernels()), diagnostics(diag) {
+    buffer.setView(text);
+    loaded = true;
 }
 
 std::string Lexer::getErrorStatement(STATE state, STATE new_state) {
@@ -393,13 +608,16 @@ std::string Lexer::getErrorStatement(STATE state, STATE new_state) {
             return "Unexpected character after ':' symbol.";
         case STATE::N_EXP:
             return "Malformed exponent in floating point number.";
+        case STATE::C_BLOCK:
+        case STATE::C_BLOCK_STAR:
+            return "Unterminated comment.";
         default:
             return "Unrecognized token encountered.";
     }
 }
 
 bool Lexer::setBuffer(const char* filename) {
-    return buffer.setFile(filename);
+    return loaded = buffer.setFile(filename);
 }
 
 void Lexer::transition(STATE &state, STATE &new_state, const STATE &next_state) {
@@ -407,34 +625,121 @@ void Lexer::transition(STATE &state, STATE &new_state, const STATE &next_state)
     new_state = next_state;
 }
 
+void Lexer::skipWhitespace() {
+    std::string_view rest = buffer.remaining();
+    buffer.skip(kernels.skipWhitespace(rest.data(), rest.size()));
+    buffer.dropLexeme();
+}
+
+void Lexer::skipRun(STATE state) {
+    std::string_view rest = buffer.remaining();
+    switch (state) {
+        case STATE::I1:
+            buffer.skip(kernels.skipAlnum(rest.data(), rest.size()));
+            break;
+        case STATE::I_UND:
+            buffer.skip(kernels.skipIdentifierTail(rest.data(), rest.size()));
+            break;
+        case STATE::N1:
+        case STATE::N_DECIMAL_N:
+        case STATE::N_EXP_N:
+            buffer.skip(kernels.skipDigits(rest.data(), rest.size()));
+            break;
+        case STATE::SL1:
+            buffer.skip(kernels.skipStringBody(rest.data(), rest.size()));
+            break;
+        case STATE::C_LINE:
+            buffer.skip(kernels.findLineEnd(rest.data(), rest.size()));
+            break;
+        case STATE::C_BLOCK:
+            buffer.skip(kernels.findBlockEnd(rest.data(), rest.size()));
+            break;
+        default:
+            break;
+    }
+    if (TRANSITION_TABLE::isComment(state))
+        buffer.dropLexeme();
+}
+
+/*
+ * converts a number the DFA accepted; a value out of range is reported and saturates, and one
+ * from_chars cannot read in full is reported and stored as 0
+ */
+int32_t Lexer::insertNumber(std::string_view lexeme) {
+    // from_chars takes a '-' but not a '+'
+    const char* first = lexeme.data() + (lexeme[0] == '+');
+    const char* last = lexeme.data() + lexeme.size();
+    bool negative = lexeme[0] == '-';
+    LITERAL_TABLE_ENTRY number;
+    if (lexeme.find_first_of(".Ee") == std::string_view::npos) {
+        int64_t value = 0;
+        std::from_chars_result result = std::from_chars(first, last, value);
+        if (result.ec == std::errc::result_out_of_range) {
+            diagnostics << "[LEX ERROR]: Integer out of range." << std::endl;
+            value = negative ? INT64_MIN : INT64_MAX;
+        } else if (result.ec != std::errc() || result.ptr != last) {
+            diagnostics << "[LEX ERROR]: Invalid integer '" << lexeme << "'." << std::endl;
+            value = 0;
+        }
+        number = LITERAL_TABLE_ENTRY(value);
+    } else {
+        double value = 0.0;
+        std::from_chars_result result = std::from_chars(first, last, value);
+        if (result.ec == std::errc::result_out_of_range) {
+            // a negative exponent means the value is too small rather than too large
+            size_t exponent = lexeme.find_first_of("Ee");
+            if (exponent + 1 < lexeme.size() && lexeme[exponent + 1] == '-') {
+                value = negative ? -0.0 : 0.0;
+            } else {
+                diagnostics << "[LEX ERROR]: Floating point number out of range." << std::endl;
+                value = negative ? -HUGE_VAL : HUGE_VAL;
+            }
+        } else if (result.ec != std::errc() || result.ptr != last) {
+            diagnostics << "[LEX ERROR]: Invalid floating point number '" << lexeme << "'." << std::endl;
+            value = 0.0;
+        }
+        number = LITERAL_TABLE_ENTRY(value);
+    }
+    return insertValue(literal_table, number);
+}
+
 TOKEN Lexer::getNextToken() {
     char c;
     STATE state = STATE::START;
     STATE new_state = STATE::START;
-    std::string t_lexeme;
-    size_t token_id = -1;
+    std::string_view t_lexeme;
+    TOKEN_KIND kind = TK_NONE;
+    int32_t token_id = -1;
     TOKEN_CLASS token_class = T_EOF;
 
-    while (buffer.peekNextCharacter() != __EOF__) {
-        t_lexeme = "";
-
-        if (isspace(buffer.peekNextCharacter())) {
-            ++current_token_lines;
-            current_token_columns=0;
-            buffer.advance();
-            buffer.advanceBp();
+    while (true) {
+        if (new_state == STATE::START) {
+            skipWhitespace();
+            if (buffer.peekNextCharacter() == __EOF__)
+                break;
+            current_token_lines = buffer.getLine();
         }
-        while (!transition_table.isFinal(new_state) && new_state != STATE::ERROR_STATE) {
+        while (!TRANSITION_TABLE::isFinal(new_state) && new_state != STATE::ERROR_STATE) {
             c = buffer.peekNextCharacter();
-            transition(state, new_state, transition_table[new_state][c]);
-            if (transition_table.advance(state, new_state))
+            if (c == __EOF__ && buffer.remaining().empty())
+                ends_clean = false;
+            transition(state, new_state, TRANSITION_TABLE::next(new_state, c));
+            if (TRANSITION_TABLE::advance(state, new_state))
                 buffer.advance();
+            if (TRANSITION_TABLE::hasRun(new_state))
+                skipRun(new_state);
+        }
+        if (new_state == STATE::C_END) {
+            // comments only separate tokens
+            buffer.dropLexeme();
+            new_state = STATE::START;
+            continue;
         }
         if (new_state == STATE::K_CHECK) {
             t_lexeme = buffer.peekLexeme();
-            if (keywords.count(t_lexeme) == 0) {
-                std::cout << t_lexeme << std::endl;
-                transition(state, new_state, transition_table[new_state][t_lexeme]);
+            kind = lookupKeyword(t_lexeme);
+            if (kind == TK_NONE) {
+                transition(state, new_state, TRANSITION_TABLE::next(new_state, t_lexeme));
                 if (new_state != STATE::ERROR_STATE)
                     continue;
             }
@@ -445,165 +750,138 @@ TOKEN Lexer::getNextToken() {
             state = new_state == STATE::ERROR_STATE ? state : new_state;
             new_state = STATE::ERROR_STATE;
 
-            std::cout << "[LEX ERROR]: " << getErrorStatement(state, new_state) << std::endl;
+            diagnostics << "[LEX ERROR]: " << getErrorStatement(state, new_state) << std::endl;
             new_state = STATE::START;
-            buffer.popLexeme();
+            buffer.dropLexeme();
             continue;
         }
-        ++current_token_columns;
+        size_t offset = buffer.lexemeStart();
         t_lexeme = buffer.popLexeme();
-        token_class = transition_table.getTokenClass(new_state);
-        if (token_class == TOKEN_CLASS::Identifier) {
-            token_id = symbol_table.insert(t_lexeme, SYMBOL_TABLE_ENTRY(token_class, t_lexeme, DATA_TYPE::T_DEFAULT));
-            return TOKEN(token_id, std::nullopt, token_class, current_token_lines, current_token_columns);
-        } else if (token_class == TOKEN_CLASS::Number || token_class == TOKEN_CLASS::String_Literal) {
-            token_id = literal_table.insert(t_lexeme, LITERAL_TABLE_ENTRY(t_lexeme, DATA_TYPE::T_DEFAULT));
-            return TOKEN(token_id, std::nullopt, token_class, current_token_lines, current_token_columns);
+        token_class = TRANSITION_TABLE::getTokenClass(new_state);
+        switch (token_class) {
+            case TOKEN_CLASS::Identifier:
+                kind = TK_IDENTIFIER;
+                token_id = symbol_table.insert(t_lexeme, SYMBOL_TABLE_ENTRY(token_class, DATA_TYPE::T_DEFAULT));
+                break;
+            case TOKEN_CLASS::Number:
+            case TOKEN_CLASS::String_Literal:
+                kind = token_class == TOKEN_CLASS::Number ? TK_NUMBER : TK_STRING;
+                token_id = kind == TK_NUMBER ? insertNumber(t_lexeme) : literal_table.insert(t_lexeme, LITERAL_TABLE_ENTRY(DATA_TYPE::T_MATN));
+                break;
+            case TOKEN_CLASS::Keyword:
+                // output<- and input-> reach K_FINAL without passing the K_CHECK lookup
+                if (kind == TK_NONE)
+                    kind = lookupKeyword(t_lexeme);
+                break;
+            default:
+                kind = operatorKind(t_lexeme);
+                break;
         }
-
-        break;
+        return TOKEN(token_class, token_id, offset, t_lexeme.size(), current_token_lines, kind);
     }
-    return TOKEN(-1, t_lexeme, token_class, current_token_lines, current_token_columns);
+    return TOKEN(token_class, -1, buffer.lexemeStart(), 0, buffer.getLine(), TK_EOF);
 }
 
 bool Lexer::isEmpty() {
     return buffer.peekNextCharacter() == __EOF__;
 }
 
-int Scanner(const char *filename) {
-    
+std::string_view Lexer::source() const {
+    return std::string_view(buffer.data(), buffer.size());
+}
 
-    int fd = open(filename, O_RDONLY);
-    if (fd == -1) {
-        std::cerr << "Error opening file: " << filename << "\n";
+bool Lexer::endedClean() const {
+    return ends_clean;
+}
+
+size_t Lexer::position() const {
+    return buffer.lexemeStart();
+}
+
+std::string_view lexemeAt(std::string_view text, uint32_t offset, uint16_t length) {
+    if (length < 0xFFFF)
+        return text.substr(offset, length);
+    // the DFA starts from START at a token either way, so lexing from here finds the same token
+    TABLE<SYMBOL_TABLE_ENTRY> symbols;
+    TABLE<LITERAL_TABLE_ENTRY> literals;
+    std::ostream discard(nullptr);
+    Lexer lex(text.substr(offset), symbols, literals, discard);
+    lex.getNextToken();
+    return text.substr(offset, lex.position());
+}
+
+void scanSource(const char* source, size_t size, std::string& scanned, const SCAN_KERNELS& kernels) {
+    size_t i = 0;
+    while (i < size) {
+        // copy ordinary bytes in bulk
+        size_t run = kernels.findSpecial(source + i, size - i);
+        scanned.append(source + i, run);
+        i += run;
+        if (i >= size)
+            break;
+
+        bool comment_start = source[i] == '/' && i + 1 < size && (source[i + 1] == '/' || source[i + 1] == '*');
+        if (source[i] == '/' && !comment_start) {
+            scanned += '/';
+            ++i;
+            continue;
+        }
+
+        // a run of whitespace and comments collapses to its first whitespace byte, or one space
+        char replacement = comment_start ? ' ' : source[i];
+        while (i < size) {
+            if (isSpace(source[i])) {
+                i += kernels.skipWhitespace(source + i, size - i);
+            } else if (source[i] == '/' && i + 1 < size && source[i + 1] == '/') {
+                i += 2;
+                i += kernels.findLineEnd(source + i, size - i);
+                i += i < size;   // the newline belongs to the comment
+            } else if (source[i] == '/' && i + 1 < size && source[i + 1] == '*') {
+                i += 2;
+                i += kernels.findBlockEnd(source + i, size - i);
+                i = i + 2 < size ? i + 2 : size;
+            } else {
+                break;
+            }
+        }
+        scanned += replacement;
+    }
+}
+
+int Scanner(const char *filename) {
+    BUFFER input(filename);
+    if (!input.isLoaded()) {
         return -1;
     }
 
-    const int buffer_size = BUFFER_SIZE;
-    char buffer[buffer_size];
-    char out_buffer[buffer_size];
-    int bytes_read = 0;
+    std::string scanned;
+    scanned.reserve(input.size());
+    scanSource(input.data(), input.size(), scanned, scanKernels());
 
     std::string scanned_filename = std::string(filename) + ".Meow";
     int out_fd = open(scanned_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (out_fd == -1) {
         std::cerr << "Error opening output file: " << scanned_filename << "\n";
-        close(fd);
         return -1;
     }
 
-    bool lastSlash = false;
-    bool remove_one_line = false;
-    bool remove_multi_line = false;
-    int out_file_index = 0;
-    bool lastStar = false;
-    bool lastWhitespace = false;
-    bool last_space = false;
-    bool last_comment = false;
-
-    while ((bytes_read = read(fd, buffer, buffer_size)) > 0) {
-
-        for (int i = 0; i < bytes_read; i++) {
-
-            // write in out file buffer is full
-            if (out_file_index >= buffer_size) {
-                write(out_fd, out_buffer, out_file_index);
-                out_file_index = 0;
-            }
-
-            // if last char was backslash check if comment starts
-            if (lastSlash) {                             
-                remove_multi_line = (buffer[i] == '*');
-                remove_one_line = (buffer[i] == '/');
-                if (remove_multi_line || remove_one_line) {
-                    ++i;
-                } else {
-                    out_buffer[out_file_index++] = '/';
-                }
-                lastSlash = false;
-            }
-
-            if (remove_multi_line) {
-                while (i < bytes_read - 1) {
-                    
-                    if (lastStar && buffer[i] == '/') {
-                        remove_multi_line = false;
-                        lastStar = false;
-                        i++;            // Skip '/'
-
-                        if(!last_space)                         //replace with white space
-                            out_buffer[out_file_index++] = ' ';
-                        last_comment=true;
-                        break;
-                    }
-                    lastStar = buffer[i] == '*'; 
-                    i++;
-                }
-                    
-                continue; // Skip remaining comment characters
-            }
-
-            if (remove_one_line) {
-                while (i < bytes_read && buffer[i] != '\n') {
-                    i++;
-                }
-                if ( i < bytes_read)
-                {
-                    if(!last_space)
-                        out_buffer[out_file_index++] = ' ';
-                    remove_one_line = false;
-                    last_comment=true;
-                }
-                continue;
-            }
-
-            if (buffer[i] == '/') {
-                lastSlash = true;
-                continue;
-            }
-
-            
-
-            //skip whitespaces
-            if(lastWhitespace) {
-                while (isspace(buffer[i]) && i < bytes_read){
-                    ++i;
-                } 
-                if(i < bytes_read) {
-                    lastWhitespace = false;
-                    i--;
-                }
-
-                continue;
-            }
-
-            if (isspace(buffer[i])) {
-                if(!last_comment)
-                    out_buffer[out_file_index++] = buffer[i];
-                lastWhitespace = true;
-                last_space=true;
-                continue;
-                
-            }
-
-            last_space=last_comment=false;
-
-            out_buffer[out_file_index++] = buffer[i];
-            
+    size_t written = 0;
+    while (written < scanned.size()) {
+        ssize_t bytes_written = write(out_fd, scanned.data() + written, scanned.size() - written);
+        if (bytes_written == -1) {
+            std::cerr << "Error writing output file: " << scanned_filename << "\n";
+            close(out_fd);
+            return -1;
         }
+        written += bytes_written;
     }
 
-    if (out_file_index > 0) {
-        write(out_fd, out_buffer, out_file_index);
-    }
-
-    close(fd);
     close(out_fd);
     return 1;
 }
 
 
-bool writeTokenToFile(std::vector<TOKEN>& token_stream, std::string& filename) {
+bool writeTokenToFile(const TokenStream& token_stream, std::string& filename) {
     int fd = open(filename.c_str(), O_CREAT|O_WRONLY,0644);
 
     if(fd == -1) {
@@ -611,17 +889,15 @@ bool writeTokenToFile(std::vector<TOKEN>& token_stream, std::string& filename) {
         return false;
     }
 
-    int i=0;
     std::string buffer;
-    for(const auto& e:token_stream) { 
-        buffer = std::to_string(i)+ "\t"+ e.toString() + "\n";
+    for(size_t i = 0; i < token_stream.size(); ++i) { 
+        buffer = std::to_string(i)+ "\t"+ token_stream.toString(i) + "\n";
         ssize_t bytes_written = write(fd, buffer.c_str(),buffer.size());
         if (bytes_written == -1) {
             std::cerr << "writeTokenToFile() unable to write to file\n";
             close(fd);
             return false;
         }
-        ++i;
     }
     close(fd);
 
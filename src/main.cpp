@@ -1,57 +1,258 @@
 
 #include <iostream>
 #include <vector>
+#include <climits>
+#include <cstring>
+#include <thread>
 #include "lexer.hpp"
+#include "chunked_lexer.hpp"
 #include <parser.hpp>
+#include "token_ring.hpp"
+#include "session.hpp"
+#include "parallel_parser.hpp"
+#include "scope.hpp"
+#include "tac.hpp"
+#include "optimizer.hpp"
+#include "vm.hpp"
+#include <fcntl.h>
+#include <unistd.h>
 
+enum class TREE_OUTPUT { None, Text, Binary };
+
+/*a thread count is all digits, 0 meaning every core*/
+static bool isCount(const char* text) {
+    return *text != '\0' && strspn(text, "0123456789") == strlen(text);
+}
+
+static void printDiagnostics(const std::vector<DIAGNOSTIC>& diagnostics) {
+    for (const DIAGNOSTIC& diagnostic : diagnostics) {
+        std::cerr << diagnostic.toString() << "\n";
+    }
+}
+
+/*names used but not declared, or declared twice in one scope, are only warned about*/
+static NAME_BINDINGS checkNames(const AST& tree, const TokenStream& tokens) {
+    NAME_BINDINGS names = bindNames(tree, tokens);
+    for (uint32_t node : names.undeclared) {
+        uint32_t token = tree[node].token;
+        std::cerr << "[NAME WARNING] '" << tokens.lexeme(token) << "' is not declared at line " << tokens.line(token) << "\n";
+    }
+    for (uint32_t node : names.redeclared) {
+        uint32_t token = tree[node].token;
+        std::cerr << "[NAME WARNING] '" << tokens.lexeme(token) << "' is already declared in this scope at line " << tokens.line(token) << "\n";
+    }
+    return names;
+}
+
+/*what to do with a tree that parsed without errors, besides checking its names*/
+struct CODE_OPTIONS {
+    TABLE<LITERAL_TABLE_ENTRY>* literal_table = nullptr;    // set when code is generated at all
+    bool tac = false;           // --tac writes three address code to output/tac.txt
+    bool optimize = false;      // -O1
+    bool run = false;           // --run[=function] runs the programme, from its last function by default
+    const char* entry = nullptr;
+};
+
+static bool writeTAC(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                     const TABLE<LITERAL_TABLE_ENTRY>& literal_table) {
+    std::string text = tacToString(tac, tree, tokens, names, literal_table);
+    int fd = open("output/tac.txt", O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1) {
+        std::cerr << "writeTAC() unable to open output/tac.txt\n";
+        return false;
+    }
+    bool ok = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    return ok;
+}
+
+/*compiles tac to bytecode and runs it; the programme's result is the exit status*/
+static int run(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+               const TABLE<LITERAL_TABLE_ENTRY>& literal_table, const char* entry_name) {
+    BYTECODE bytecode;
+    std::vector<std::string> errors;
+    if (!compileBytecode(tac, tree, tokens, names, literal_table, bytecode, errors)) {
+        for (const std::string& error : errors) {
+            std::cerr << "[RUN ERROR] " << error << "\n";
+        }
+        return EXIT_FAILURE;
+    }
+    uint32_t entry = entry_name != nullptr ? bytecode.findFunction(entry_name)
+                     : bytecode.functions.empty() ? BYTECODE::NO_FUNCTION : static_cast<uint32_t>(bytecode.functions.size() - 1);
+    if (entry == BYTECODE::NO_FUNCTION) {
+        std::cerr << "[RUN ERROR] no function " << (entry_name != nullptr ? entry_name : "") << " to run\n";
+        return EXIT_FAILURE;
+    }
+    if (bytecode.functions[entry].params != 0) {
+        std::cerr << "[RUN ERROR] '" << bytecode.functions[entry].name << "' takes parameters, so it cannot be run\n";
+        return EXIT_FAILURE;
+    }
+    return runBytecode(bytecode, entry);
+}
+
+/*name checks, then code generation; a name with no declaration has nothing to translate to*/
+static int translate(const AST& tree, const TokenStream& tokens, const CODE_OPTIONS& options) {
+    NAME_BINDINGS names = checkNames(tree, tokens);
+    if (options.literal_table == nullptr)
+        return EXIT_SUCCESS;
+    if (!names.undeclared.empty()) {
+        std::cerr << "undeclared names, no three address code generated\n";
+        return options.run ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    TAC tac = generateTAC(tree, tokens, names, *options.literal_table);
+    std::cout << "----------Generated " << tac.code.size() << " quads---------\n";
+    if (options.optimize) {
+        OPTIMIZE_STATS stats = optimizeTAC(tac, names, *options.literal_table);
+        std::cout << "----------O1 removed " << stats.removed << " of " << stats.quads << " quads ("
+                  << stats.folded << " folded, " << stats.branches << " branches decided)---------\n";
+    }
+    if (options.tac)
+        writeTAC(tac, tree, tokens, names, *options.literal_table);
+    return options.run ? run(tac, tree, tokens, names, *options.literal_table, options.entry) : EXIT_SUCCESS;
+}
+
+// the exit status: EXIT_FAILURE if the programme does not parse or its parse tree could not be written
+template <typename SINK, typename SOURCE>
+static int parseWith(SOURCE source, const CODE_OPTIONS& code) {
+    Parser<SINK, SOURCE> parser(std::move(source));
+    bool ok = parser.programme();
+    printDiagnostics(parser.diagnostics());
+    if (!parser.flushTree())
+        return EXIT_FAILURE;
+    return ok ? translate(parser.tree(), parser.tokenStream(), code) : EXIT_FAILURE;
+}
+
+template <typename SOURCE>
+static int parse(TREE_OUTPUT tree_output, SOURCE source, const CODE_OPTIONS& code) {
+    switch (tree_output) {
+        case TREE_OUTPUT::Text: return parseWith<TEXT_SINK>(std::move(source), code);
+        case TREE_OUTPUT::Binary: return parseWith<BINARY_SINK>(std::move(source), code);
+        default: return parseWith<NULL_SINK>(std::move(source), code);
+    }
+}
+
+/*
+ * lexes on a second thread and parses the tokens as they arrive; the token stream is never
+ * stored or printed. the exit status is parse()'s
+ */
+static int lexAndParsePipelined(Lexer& lex, TREE_OUTPUT tree_output, const CODE_OPTIONS& code) {
+    TOKEN_RING ring;
+    std::thread lexer_thread([&]() {
+        while (!lex.isEmpty()) {
+            TOKEN token = lex.getNextToken();
+            if (token.t_class == TOKEN_CLASS::T_EOF)
+                break;
+            ring.push(token);
+        }
+        ring.push(TOKEN(TOKEN_CLASS::T_EOF, -1, 0, 0, 0, TK_EOF));
+    });
+    // the parse only ends once it has the EOF token, so the lexer is done with the tables before translate() reads them
+    int status = parse(tree_output, RING_SOURCE(ring, lex.source()), code);
+    lexer_thread.join();
+    return status;
+}
 
 int main(int argc, char* args[]) {
 
-    if (argc == 1){
+    const char* input_filename = nullptr;
+    unsigned threads = 1;       // -jN lexes and parses in N threads, -j0 uses every core
+    TREE_OUTPUT tree_output = TREE_OUTPUT::None;    // --tree[=text|binary|none] writes output/parse_tree.*
+    bool pipelined = false;     // --pipeline parses on this thread while another one lexes
+    bool serving = false;       // --serve keeps the file parsed and applies edits from stdin
+    CODE_OPTIONS code;          // --tac, -O1 and --run
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(args[i], "-j", 2) == 0) {
+            // a bare -j only takes the next argument if it is a count, and means every core otherwise
+            const char* count = args[i][2] != '\0' ? args[i] + 2 : (i + 1 < argc && isCount(args[i + 1]) ? args[++i] : "0");
+            unsigned long parsed = isCount(count) ? strtoul(count, nullptr, 10) : ULONG_MAX;
+            if (parsed > UINT_MAX) {
+                std::cerr << "invalid thread count " << count << ", expected -j[N]" << std::endl;
+                exit(1);
+            }
+            threads = static_cast<unsigned>(parsed);
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+        } else if (strcmp(args[i], "--pipeline") == 0) {
+            pipelined = true;
+        } else if (strcmp(args[i], "--serve") == 0) {
+            serving = true;
+        } else if (strcmp(args[i], "--tac") == 0) {
+            code.tac = true;
+        } else if (strcmp(args[i], "--run") == 0 || strncmp(args[i], "--run=", 6) == 0) {
+            code.run = true;
+            code.entry = args[i][5] == '=' ? args[i] + 6 : nullptr;
+        } else if (strcmp(args[i], "-O1") == 0) {
+            code.optimize = true;
+        } else if (strcmp(args[i], "-O0") == 0) {
+            code.optimize = false;
+        } else if (strcmp(args[i], "--tree") == 0 || strcmp(args[i], "--tree=text") == 0) {
+            tree_output = TREE_OUTPUT::Text;
+        } else if (strcmp(args[i], "--tree=binary") == 0) {
+            tree_output = TREE_OUTPUT::Binary;
+        } else if (strcmp(args[i], "--tree=none") == 0) {
+            tree_output = TREE_OUTPUT::None;
+        } else if (strncmp(args[i], "--tree", 6) == 0) {
+            std::cerr << "unknown tree output " << args[i] << ", expected --tree[=text|binary|none]" << std::endl;
+            exit(1);
+        } else {
+            input_filename = args[i];
+        }
+    }
+
+    if (input_filename == nullptr){
         std::cerr << "NO FILE SPECIFIED" << std::endl;
         exit(1);
     }
 
+    if (serving)
+        return serve(input_filename);
 
+    // a programme that is run owns stdout; the compiler's own reports are dropped
+    if (code.run)
+        std::cout.rdbuf(nullptr);
 
     clock_t start_time = clock(); 
-    const char* input_filename = args[1];
-    std::unordered_set<std::string> keywords = {
-        "asm", "Wagarna", "new", "this", "auto", "enum", "operator", "throw", "Mantiqi",
-        "explicit", "private", "True", "break", "export", "protected", "try", "case", 
-        "extern", "public", "typedef", "catch", "False", "register", "typeid", "Harf", 
-        "Ashriya", "typename", "Adadi", "class", "for", "Wapas", "union", "const", 
-        "dost", "short", "unsigned", "goto", "signed", "using", "continue", "Agar", 
-        "sizeof", "virtual", "default", "inline", "static", "Khali", "delete", 
-        "volatile", "do", "long", "struct", "double", "mutable", "switch", "while", 
-        "namespace", "template", "Marqazi", "Matn", "output->", "input<-"
-    };
-    
-    
+
     TABLE<SYMBOL_TABLE_ENTRY> symbol_table;
     TABLE<LITERAL_TABLE_ENTRY> literal_table;
-    std::vector<TOKEN> token_stream;
 
-    Scanner(input_filename);
+    Lexer lex(input_filename,symbol_table,literal_table);
+    if (!lex.ok()) {
+        std::cerr << "Error opening file: " << input_filename << "\n";
+        return EXIT_FAILURE;
+    }
+    if (code.tac || code.optimize || code.run)
+        code.literal_table = &literal_table;
 
-    
-    double scanner_time = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-    std::cout <<"Scan complete. Time: " <<scanner_time << std::endl;
-    
+    if (pipelined) {
+        std::cout << "----------Lexer + Parser (pipelined)----------\n";
+        int status = lexAndParsePipelined(lex, tree_output, code);
+        std::cout << "Lexed and parsed. Time: " << (double)(clock() - start_time) / CLOCKS_PER_SEC << std::endl;
+        symbol_table.writeToFile("output/symbol_table_"+ ROLL_NO +".txt");
+        literal_table.writeToFile("output/literal_table_" + ROLL_NO +".txt");
+        return status;
+    }
 
-    Lexer lex((std::string(input_filename) + ".Meow").c_str(),symbol_table,literal_table,keywords);
-    while (!lex.isEmpty())
+    TokenStream token_stream(lex.source());
+    if (threads > 1) {
+        lexChunked(lex.source(), threads, symbol_table, literal_table, token_stream);
+    }
+    else while (!lex.isEmpty())
     {
-        token_stream.push_back(std::move(lex.getNextToken()));
+        TOKEN token = lex.getNextToken();
+        if (token.t_class == TOKEN_CLASS::T_EOF)
+            break;
+        token_stream.push_back(token);
     }
 
 
     std::cout << "\n\n--------TOKEN STREAM-------\n\n";
-    for (const auto& token: token_stream) {
-        std::cout << token.toString() << std::endl;
+    for (size_t i = 0; i < token_stream.size(); ++i) {
+        std::cout << token_stream.toString(i) << std::endl;
     }
 
-    std::cout <<"Tokens generated. Time: " << (double)(clock() - start_time) / CLOCKS_PER_SEC - scanner_time << std::endl;
+    std::cout <<"Tokens generated. Time: " << (double)(clock() - start_time) / CLOCKS_PER_SEC << std::endl;
  
 
     
@@ -60,9 +261,13 @@ int main(int argc, char* args[]) {
     std::cout << "----------Generated Lexer Output files---------\n";
 
     std::cout << "----------Parser----------\n";
-    Parser parser(token_stream);
-
-    parser.programme();
-
-    return EXIT_SUCCESS;    
+    // the tree sinks write one file in parse order, so only a parse without one is split up
+    if (threads > 1 && tree_output == TREE_OUTPUT::None) {
+        AST tree;
+        std::vector<DIAGNOSTIC> diagnostics;
+        bool ok = parseParallel(token_stream, threads, tree, diagnostics);
+        printDiagnostics(diagnostics);
+        return ok ? translate(tree, token_stream, code) : EXIT_FAILURE;
+    }
+    return parse(tree_output, STREAM_SOURCE(std::move(token_stream)), code);
 }
\ No newline at end of file
@@ -0,0 +1,505 @@
+#include "optimizer.hpp"
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+constexpr TAC_OP REMOVED = TAC_OP_COUNT;   // quads dropped, until the code is compacted
+
+/*the constant propagation lattice: no value seen yet, one constant, or anything*/
+enum LATTICE : uint8_t { UNKNOWN, CONSTANT, VARYING };
+
+struct VALUE {
+    LATTICE state = UNKNOWN;
+    LITERAL_TABLE_ENTRY constant;
+};
+
+bool sameConstant(const LITERAL_TABLE_ENTRY& a, const LITERAL_TABLE_ENTRY& b) {
+    return a.datatype == b.datatype && a.integer == b.integer;
+}
+
+VALUE meet(const VALUE& a, const VALUE& b) {
+    if (a.state == UNKNOWN) return b;
+    if (b.state == UNKNOWN) return a;
+    if (a.state == CONSTANT && b.state == CONSTANT && sameConstant(a.constant, b.constant)) return a;
+    return {VARYING, {}};
+}
+
+bool isNumeric(const LITERAL_TABLE_ENTRY& value) {
+    return value.datatype == T_ADADI || value.datatype == T_ASHRIYA || value.datatype == T_MANTIQI
+        || value.datatype == T_HARF;
+}
+
+bool truthy(const LITERAL_TABLE_ENTRY& value) {
+    return value.datatype == T_ASHRIYA ? value.decimal != 0 : value.integer != 0;
+}
+
+template <typename T>
+bool compare(TAC_OP op, T a, T b) {
+    switch (op) {
+        case TAC_EQ: return a == b;
+        case TAC_NE: return a != b;
+        case TAC_LT: return a < b;
+        case TAC_GT: return a > b;
+        case TAC_LE: return a <= b;
+        default: return a >= b;
+    }
+}
+
+/*a op b by the rules in tac.hpp; false if it has to wait for run time*/
+bool fold(TAC_OP op, const LITERAL_TABLE_ENTRY& a, const LITERAL_TABLE_ENTRY& b, LITERAL_TABLE_ENTRY& result) {
+    if (!isNumeric(a) || !isNumeric(b))
+        return false;
+    if (a.datatype == T_ASHRIYA || b.datatype == T_ASHRIYA) {
+        double x = a.datatype == T_ASHRIYA ? a.decimal : static_cast<double>(a.integer);
+        double y = b.datatype == T_ASHRIYA ? b.decimal : static_cast<double>(b.integer);
+        switch (op) {
+            case TAC_ADD: result = LITERAL_TABLE_ENTRY(x + y); return true;
+            case TAC_SUBTRACT: result = LITERAL_TABLE_ENTRY(x - y); return true;
+            case TAC_MULTIPLY: result = LITERAL_TABLE_ENTRY(x * y); return true;
+            case TAC_DIVIDE: result = LITERAL_TABLE_ENTRY(x / y); return true;
+            default: result = LITERAL_TABLE_ENTRY(compare(op, x, y)); return true;
+        }
+    }
+    int64_t x = a.integer, y = b.integer, z;
+    switch (op) {
+        case TAC_ADD: if (__builtin_add_overflow(x, y, &z)) return false; break;
+        case TAC_SUBTRACT: if (__builtin_sub_overflow(x, y, &z)) return false; break;
+        case TAC_MULTIPLY: if (__builtin_mul_overflow(x, y, &z)) return false; break;
+        case TAC_DIVIDE:
+            if (y == 0 || (x == INT64_MIN && y == -1)) return false;
+            z = x / y;
+            break;
+        default: result = LITERAL_TABLE_ENTRY(compare(op, x, y)); return true;
+    }
+    result = LITERAL_TABLE_ENTRY(z);
+    return true;
+}
+
+bool isBinary(TAC_OP op) {
+    return op >= TAC_ADD && op <= TAC_GE;
+}
+
+bool defines(TAC_OP op) {
+    return op == TAC_COPY || op == TAC_PARAM || op == TAC_CALL || op == TAC_INPUT || isBinary(op);
+}
+
+bool usesOperand(OPERAND_KIND kind) {
+    return kind == OPERAND_TEMP || kind == OPERAND_SYMBOL;
+}
+
+/*
+ * works on one function at a time, code[begin, end). quads are numbered from 0 within the
+ * function and an operand use is 2 * quad + 0 for left, + 1 for right. arrays indexed by
+ * symbol are shared by every function and stamped, so nothing is cleared per function.
+ */
+class FUNCTION_OPTIMIZER {
+public:
+    FUNCTION_OPTIMIZER(TAC& _tac, const NAME_BINDINGS& _names, TABLE<LITERAL_TABLE_ENTRY>& _literal_table,
+                       OPTIMIZE_STATS& _stats)
+        : tac(_tac), names(_names), literal_table(_literal_table), stats(_stats) {
+        size_t symbol_count = names.scopes.symbols().size();
+        symbols.resize(symbol_count);
+    }
+
+    void run(size_t _begin, size_t _end) {
+        begin = _begin;
+        n = static_cast<uint32_t>(_end - _begin);
+        ++function_stamp;
+        findBlocks();
+        propagate();
+        rewrite();
+        removeDeadCode();
+    }
+
+private:
+    struct BLOCK {
+        uint32_t first;
+        bool executable;
+    };
+
+    /*what is known of one symbol in the function being optimized*/
+    struct SYMBOL_STATE {
+        uint32_t function = 0;      // stamp; anything else means not yet seen in this function
+        VALUE value;                // meet of the assignments leaving blocks
+        uint32_t exposed = NONE;    // uses not preceded by an assignment in their block, linked by next_use
+        uint32_t exported = NONE;   // assignments last in their block, linked by next_export
+        uint32_t reads = 0;         // exposed uses still in the code
+        uint32_t block = 0;         // stamp of the block last_def was made in
+        uint32_t last_def = NONE;
+    };
+
+    TAC& tac;
+    const NAME_BINDINGS& names;
+    TABLE<LITERAL_TABLE_ENTRY>& literal_table;
+    OPTIMIZE_STATS& stats;
+    size_t begin = 0;
+    uint32_t n = 0;
+    uint32_t function_stamp = 0;
+    uint32_t block_stamp = 0;
+
+    std::vector<SYMBOL_STATE> symbols;
+    std::vector<BLOCK> blocks;
+    std::vector<uint32_t> block_of;
+    std::vector<VALUE> values;          // by defining quad
+    std::vector<uint32_t> defs;         // by use: the quad in the same block that defined it, or NONE
+    std::vector<uint32_t> next_use;     // by use: the next use of the same definition or exposed symbol
+    std::vector<uint32_t> first_use;    // by defining quad
+    std::vector<uint32_t> next_export;  // by defining quad
+    std::vector<uint8_t> exports;       // by defining quad: last assignment to a symbol in its block
+    std::vector<uint32_t> use_count;    // by defining quad
+    std::vector<uint32_t> temp_def;     // by temporary, within the current block
+    std::vector<uint32_t> defined_here; // symbols assigned in the current block
+    std::vector<uint32_t> exposed_symbols;
+    std::vector<uint32_t> flow_work;    // blocks that just became executable
+    std::vector<uint32_t> value_work;   // quads with an operand that changed
+
+    QUAD& at(uint32_t i) { return tac.code[begin + i]; }
+
+    SYMBOL_STATE& symbol(uint32_t s) {
+        SYMBOL_STATE& state = symbols[s];
+        if (state.function != function_stamp) {
+            state = SYMBOL_STATE();
+            state.function = function_stamp;
+            // a global can be changed by any other function
+            if (names.scopes[s].depth == 0) state.value.state = VARYING;
+        }
+        return state;
+    }
+
+    bool isLocal(uint32_t s) const { return names.scopes[s].depth > 0; }
+
+    /*cuts the function into blocks and links every use to the definition it reads*/
+    void findBlocks() {
+        blocks.clear();
+        exposed_symbols.clear();
+        block_of.resize(n);
+        values.assign(n, VALUE());
+        defs.assign(2 * n, NONE);
+        next_use.assign(2 * n, NONE);
+        first_use.assign(n, NONE);
+        next_export.assign(n, NONE);
+        exports.assign(n, 0);
+        temp_def.assign(at(0).right, NONE);
+
+        bool leader = true;
+        for (uint32_t i = 0; i < n; ++i) {
+            QUAD& quad = at(i);
+            if (leader || quad.op == TAC_LABEL) {
+                endBlock();
+                blocks.push_back({i, false});
+                ++block_stamp;
+            }
+            block_of[i] = static_cast<uint32_t>(blocks.size() - 1);
+            if (quad.op == TAC_CALL) {
+                // the callee may assign any global, so reads after the call cannot see earlier assignments
+                for (uint32_t s : defined_here) {
+                    if (!isLocal(s)) symbols[s].block = 0;
+                }
+            } else {
+                linkUse(i, 0, quad.left_kind, quad.left);
+                linkUse(i, 1, quad.right_kind, quad.right);
+            }
+            if (defines(quad.op)) {
+                if (quad.result_kind == OPERAND_TEMP) {
+                    temp_def[quad.result] = i;
+                } else {
+                    SYMBOL_STATE& state = symbol(quad.result);
+                    if (state.block != block_stamp) defined_here.push_back(quad.result);
+                    state.block = block_stamp;
+                    state.last_def = i;
+                }
+            }
+            leader = quad.op == TAC_JUMP || quad.op == TAC_JUMP_IF_FALSE || quad.op == TAC_RETURN;
+        }
+        endBlock();
+    }
+
+    void linkUse(uint32_t i, uint32_t side, OPERAND_KIND kind, uint32_t index) {
+        uint32_t use = 2 * i + side;
+        if (kind == OPERAND_TEMP) {
+            defs[use] = temp_def[index];
+        } else if (kind == OPERAND_SYMBOL) {
+            SYMBOL_STATE& state = symbol(index);
+            if (state.block == block_stamp) {
+                defs[use] = state.last_def;
+            } else {
+                if (state.exposed == NONE) exposed_symbols.push_back(index);
+                next_use[use] = state.exposed;
+                state.exposed = use;
+            }
+        }
+        if (defs[use] != NONE) {
+            next_use[use] = first_use[defs[use]];
+            first_use[defs[use]] = use;
+        }
+    }
+
+    void endBlock() {
+        for (uint32_t s : defined_here) {
+            SYMBOL_STATE& state = symbols[s];
+            if (!isLocal(s)) continue;
+            exports[state.last_def] = 1;
+            next_export[state.last_def] = state.exported;
+            state.exported = state.last_def;
+        }
+        defined_here.clear();
+    }
+
+    VALUE operand(uint32_t i, uint32_t side) {
+        const QUAD& quad = at(i);
+        OPERAND_KIND kind = side ? quad.right_kind : quad.left_kind;
+        uint32_t index = side ? quad.right : quad.left;
+        if (kind == OPERAND_LITERAL) {
+            const LITERAL_TABLE_ENTRY& literal = literal_table[index];
+            return isNumeric(literal) ? VALUE{CONSTANT, literal} : VALUE{VARYING, {}};
+        }
+        uint32_t def = defs[2 * i + side];
+        if (def != NONE) return values[def];
+        if (kind == OPERAND_SYMBOL) return symbol(index).value;
+        return {VARYING, {}};
+    }
+
+    void reach(uint32_t block) {
+        if (!blocks[block].executable) {
+            blocks[block].executable = true;
+            flow_work.push_back(block);
+        }
+    }
+
+    uint32_t labelBlock(uint32_t label) {
+        return block_of[tac.labels[label] - begin];
+    }
+
+    void pushUses(uint32_t use) {
+        for (; use != NONE; use = next_use[use]) {
+            value_work.push_back(use / 2);
+        }
+    }
+
+    void evaluate(uint32_t i) {
+        const QUAD& quad = at(i);
+        VALUE value;
+        if (quad.op == TAC_JUMP_IF_FALSE) {
+            VALUE condition = operand(i, 0);
+            if (condition.state == UNKNOWN) return;
+            bool varying = condition.state == VARYING;
+            if (varying || !truthy(condition.constant)) reach(labelBlock(quad.right));
+            if (varying || truthy(condition.constant)) reach(block_of[i] + 1);
+            return;
+        }
+        if (quad.op == TAC_COPY) {
+            value = operand(i, 0);
+            if (value.state == CONSTANT && quad.result_kind == OPERAND_SYMBOL)
+                value.constant = convertTo(names.scopes[quad.result].type, value.constant);
+        } else if (quad.op == TAC_PARAM || quad.op == TAC_CALL || quad.op == TAC_INPUT) {
+            value.state = VARYING;
+        } else if (isBinary(quad.op)) {
+            VALUE left = operand(i, 0), right = operand(i, 1);
+            if (left.state == VARYING || right.state == VARYING) value.state = VARYING;
+            else if (left.state == CONSTANT && right.state == CONSTANT)
+                value.state = fold(quad.op, left.constant, right.constant, value.constant) ? CONSTANT : VARYING;
+        } else {
+            return;
+        }
+
+        VALUE lowered = meet(values[i], value);
+        if (lowered.state == values[i].state) return;
+        values[i] = lowered;
+        pushUses(first_use[i]);
+        if (exports[i] && quad.result_kind == OPERAND_SYMBOL && isLocal(quad.result)) {
+            SYMBOL_STATE& state = symbol(quad.result);
+            VALUE merged = meet(state.value, lowered);
+            if (merged.state != state.value.state) {
+                state.value = merged;
+                pushUses(state.exposed);
+            }
+        }
+    }
+
+    void visit(uint32_t block) {
+        uint32_t last = block + 1 < blocks.size() ? blocks[block + 1].first : n;
+        for (uint32_t i = blocks[block].first; i < last; ++i) {
+            evaluate(i);
+        }
+        TAC_OP op = at(last - 1).op;
+        if (op == TAC_JUMP) reach(labelBlock(at(last - 1).left));
+        else if (op != TAC_JUMP_IF_FALSE && op != TAC_RETURN && op != TAC_END && block + 1 < blocks.size())
+            reach(block + 1);
+    }
+
+    void settle() {
+        while (!flow_work.empty() || !value_work.empty()) {
+            if (!flow_work.empty()) {
+                uint32_t block = flow_work.back();
+                flow_work.pop_back();
+                visit(block);
+            } else {
+                uint32_t i = value_work.back();
+                value_work.pop_back();
+                if (blocks[block_of[i]].executable) evaluate(i);
+            }
+        }
+    }
+
+    void propagate() {
+        reach(0);
+        settle();
+        // a variable no reachable assignment reaches is read uninitialised: assume nothing
+        for (uint32_t s : exposed_symbols) {
+            SYMBOL_STATE& state = symbols[s];
+            if (state.value.state == UNKNOWN) {
+                state.value.state = VARYING;
+                pushUses(state.exposed);
+            }
+        }
+        settle();
+    }
+
+    uint32_t literal(const LITERAL_TABLE_ENTRY& constant) {
+        return insertValue(literal_table, constant);
+    }
+
+    void rewrite() {
+        for (uint32_t i = 1; i < n; ++i) {
+            QUAD& quad = at(i);
+            if (quad.op == TAC_END) continue;
+            if (!blocks[block_of[i]].executable) {
+                quad.op = REMOVED;
+                continue;
+            }
+            if (quad.op == TAC_JUMP_IF_FALSE) {
+                VALUE condition = operand(i, 0);
+                if (condition.state != CONSTANT) continue;
+                ++stats.branches;
+                if (truthy(condition.constant)) {
+                    quad.op = REMOVED;
+                } else {
+                    quad = {TAC_JUMP, OPERAND_NONE, OPERAND_LABEL, OPERAND_NONE, 0, quad.right, 0};
+                }
+                continue;
+            }
+            if ((quad.op == TAC_COPY || isBinary(quad.op)) && values[i].state == CONSTANT) {
+                if (quad.op != TAC_COPY || quad.left_kind != OPERAND_LITERAL) ++stats.folded;
+                quad = {TAC_COPY, quad.result_kind, OPERAND_LITERAL, OPERAND_NONE, quad.result, literal(values[i].constant), 0};
+                continue;
+            }
+            for (uint32_t side = 0; side < 2; ++side) {
+                OPERAND_KIND& kind = side ? quad.right_kind : quad.left_kind;
+                if (!usesOperand(kind)) continue;
+                VALUE value = operand(i, side);
+                if (value.state == CONSTANT) {
+                    kind = OPERAND_LITERAL;
+                    (side ? quad.right : quad.left) = literal(value.constant);
+                }
+            }
+        }
+    }
+
+    // an operand known to be Ashriya; temporaries are not typed here, so they never are
+    bool isDecimalOperand(OPERAND_KIND kind, uint32_t index) const {
+        if (kind == OPERAND_SYMBOL) return names.scopes[index].type == T_ASHRIYA;
+        return kind == OPERAND_LITERAL && literal_table[index].datatype == T_ASHRIYA;
+    }
+
+    // an Adadi division stops the programme on a divisor of 0, or of -1 under INT64_MIN, so it stays unless
+    // its divisor is a constant that is neither
+    bool mayTrap(const QUAD& quad) const {
+        if (quad.op != TAC_DIVIDE || isDecimalOperand(quad.left_kind, quad.left) || isDecimalOperand(quad.right_kind, quad.right))
+            return false;
+        if (quad.right_kind != OPERAND_LITERAL) return true;
+        int64_t divisor = literal_table[quad.right].integer;
+        return divisor == 0 || divisor == -1;
+    }
+
+    bool dead(uint32_t i) {
+        const QUAD& quad = at(i);
+        // calls and input have effects besides their result, and parameters are how arguments arrive
+        if ((quad.op != TAC_COPY && !isBinary(quad.op)) || use_count[i] != 0 || mayTrap(quad)) return false;
+        if (quad.result_kind == OPERAND_TEMP) return true;
+        return isLocal(quad.result) && (!exports[i] || symbols[quad.result].reads == 0);
+    }
+
+    void removeDeadCode() {
+        use_count.assign(n, 0);
+        for (uint32_t i = 0; i < n; ++i) {
+            const QUAD& quad = at(i);
+            if (quad.op == REMOVED) continue;
+            if (usesOperand(quad.left_kind)) countUse(i, 0, quad.left_kind, quad.left, 1);
+            if (usesOperand(quad.right_kind)) countUse(i, 1, quad.right_kind, quad.right, 1);
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            if (dead(i)) value_work.push_back(i);
+        }
+        while (!value_work.empty()) {
+            uint32_t i = value_work.back();
+            value_work.pop_back();
+            if (!dead(i)) continue;
+            QUAD& quad = at(i);
+            quad.op = REMOVED;
+            if (usesOperand(quad.left_kind)) countUse(i, 0, quad.left_kind, quad.left, -1);
+            if (usesOperand(quad.right_kind)) countUse(i, 1, quad.right_kind, quad.right, -1);
+        }
+    }
+
+    // adds delta to the uses of what operand side of quad i reads, queueing definitions no longer read
+    void countUse(uint32_t i, uint32_t side, OPERAND_KIND kind, uint32_t index, int delta) {
+        uint32_t def = defs[2 * i + side];
+        if (def != NONE) {
+            use_count[def] += delta;
+            if (use_count[def] == 0) value_work.push_back(def);
+        } else if (kind == OPERAND_SYMBOL) {
+            SYMBOL_STATE& state = symbol(index);
+            state.reads += delta;
+            if (state.reads == 0) {
+                for (uint32_t def = state.exported; def != NONE; def = next_export[def]) {
+                    value_work.push_back(def);
+                }
+            }
+        }
+    }
+};
+
+/*drops jumps to the label right after them, then labels nothing jumps to, then every removed quad*/
+void compact(TAC& tac) {
+    std::vector<QUAD>& code = tac.code;
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (code[i].op != TAC_JUMP) continue;
+        for (size_t next = i + 1; next < code.size() && (code[next].op == REMOVED || code[next].op == TAC_LABEL); ++next) {
+            if (code[next].op == TAC_LABEL && code[next].left == code[i].left) {
+                code[i].op = REMOVED;
+                break;
+            }
+        }
+    }
+
+    std::vector<uint8_t> targeted(tac.labels.size(), 0);
+    for (const QUAD& quad : code) {
+        if (quad.op == TAC_JUMP) targeted[quad.left] = 1;
+        else if (quad.op == TAC_JUMP_IF_FALSE) targeted[quad.right] = 1;
+    }
+    for (uint32_t& label : tac.labels) label = TAC::NO_QUAD;
+
+    size_t kept = 0;
+    for (const QUAD& quad : code) {
+        if (quad.op == REMOVED || (quad.op == TAC_LABEL && !targeted[quad.left])) continue;
+        if (quad.op == TAC_LABEL) tac.labels[quad.left] = static_cast<uint32_t>(kept);
+        code[kept++] = quad;
+    }
+    code.resize(kept);
+}
+
+}
+
+OPTIMIZE_STATS optimizeTAC(TAC& tac, const NAME_BINDINGS& names, TABLE<LITERAL_TABLE_ENTRY>& literal_table) {
+    OPTIMIZE_STATS stats;
+    stats.quads = tac.code.size();
+    FUNCTION_OPTIMIZER optimizer(tac, names, literal_table, stats);
+    for (size_t first = 0; first < tac.code.size();) {
+        size_t last = first;
+        while (tac.code[last].op != TAC_END) ++last;
+        optimizer.run(first, last + 1);
+        first = last + 1;
+    }
+    compact(tac);
+    stats.removed = stats.quads - tac.code.size();
+    return stats;
+}
@@ -0,0 +1,82 @@
+#include "parallel_parser.hpp"
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+
+// below this a run of items is not worth a thread
+static constexpr size_t MIN_RUN_TOKENS = 1 << 16;
+// runs per worker, so one slow run does not leave the other workers idle
+static constexpr size_t RUNS_PER_THREAD = 4;
+
+static void parseSerial(const TokenStream& tokens, AST& tree, std::vector<DIAGNOSTIC>& diagnostics) {
+    Parser parser(tokens);
+    parser.programme();
+    tree = parser.tree();
+    diagnostics = parser.diagnostics();
+}
+
+bool parseParallel(const TokenStream& tokens, unsigned threads, AST& tree, std::vector<DIAGNOSTIC>& diagnostics) {
+    size_t runs = std::min<size_t>(size_t(threads) * RUNS_PER_THREAD, tokens.size() / MIN_RUN_TOKENS);
+    std::vector<uint32_t> starts = runs > 1 ? splitTopLevel(tokens) : std::vector<uint32_t>();
+    if (threads < 2 || runs < 2 || starts.size() < 2) {
+        parseSerial(tokens, tree, diagnostics);
+        return diagnostics.empty();
+    }
+
+    // group whole items into runs of about the same number of tokens
+    std::vector<size_t> bounds{0};
+    for (uint32_t start : starts) {
+        if (start > bounds.back() && start >= bounds.size() * tokens.size() / runs) {
+            bounds.push_back(start);
+        }
+    }
+    if (bounds.back() != tokens.size()) {
+        bounds.push_back(tokens.size());
+    }
+    size_t count = bounds.size() - 1;
+
+    std::vector<std::optional<Parser<>>> results(count);
+    std::atomic<size_t> next_run(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        for (size_t i; !failed.load(std::memory_order_relaxed) && (i = next_run.fetch_add(1)) < count;) {
+            TokenStream run(tokens.text());
+            run.reserve(bounds[i + 1] - bounds[i]);
+            for (size_t t = bounds[i]; t < bounds[i + 1]; ++t) {
+                run.push_back(tokens[t]);
+            }
+            results[i].emplace(std::move(run));
+            if (!results[i]->programme()) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < std::min<size_t>(threads, count); ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    if (failed) {
+        parseSerial(tokens, tree, diagnostics);
+        return false;
+    }
+
+    size_t nodes = 1;
+    for (const auto& result : results) {
+        nodes += result->tree().size();
+    }
+    tree.reset();
+    tree.reserve(nodes);
+    std::vector<uint32_t> roots;
+    for (size_t i = 0; i < count; ++i) {
+        tree.append(results[i]->tree(), bounds[i], roots);
+    }
+    tree.add(NODE_PROGRAMME, TK_NONE, tokens.size() - 1, roots.data(), roots.size());
+    diagnostics.clear();
+    return true;
+}
@@ -0,0 +1,306 @@
+// generated by tools/llgen from doc/CFG.txt, do not edit
+#include "parse_table.hpp"
+#include <array>
+
+const GRAMMAR_SYMBOL PRODUCTION_SYMBOLS[] = {
+    /* Programme -> TopLevel Programme */ NT_TOPLEVEL, NT_PROGRAMME,
+    /* Programme -> ^ */
+    /* TopLevel -> Type @token identifier @token TopLevel' */ NT_TYPE, AS_TOKEN, TS_IDENTIFIER, AS_TOKEN, NT_TOPLEVEL_1,
+    /* TopLevel' -> ( @mark ArgList ) CompStmt @function */ TS_LPAREN, AS_MARK, NT_ARGLIST, TS_RPAREN, NT_COMPSTMT, AS_FUNCTION,
+    /* TopLevel' -> :: @global */ TS_TERMINATOR, AS_GLOBAL,
+    /* Type -> Adadi */ TS_ADADI,
+    /* Type -> Ashriya */ TS_ASHRIYA,
+    /* Type -> Harf */ TS_HARF,
+    /* Type -> Matn */ TS_MATN,
+    /* Type -> Mantiqi */ TS_MANTIQI,
+    /* ArgList -> Type @token identifier @param ArgList' */ NT_TYPE, AS_TOKEN, TS_IDENTIFIER, AS_PARAM, NT_ARGLIST_1,
+    /* ArgList -> ^ */
+    /* ArgList' -> , ArgList */ TS_COMMA, NT_ARGLIST,
+    /* ArgList' -> ^ */
+    /* Declaration -> Type @token @mark identifier @identifier IdentList :: @declaration */ NT_TYPE, AS_TOKEN, AS_MARK, TS_IDENTIFIER, AS_IDENTIFIER, NT_IDENTLIST, TS_TERMINATOR, AS_DECLARATION,
+    /* IdentList -> , identifier @identifier IdentList */ TS_COMMA, TS_IDENTIFIER, AS_IDENTIFIER, NT_IDENTLIST,
+    /* IdentList -> ^ */
+    /* Stmt -> IfStmt */ NT_IFSTMT,
+    /* Stmt -> NoIfStmt */ NT_NOIFSTMT,
+    /* NoIfStmt -> ForStmt */ NT_FORSTMT,
+    /* NoIfStmt -> WhileStmt */ NT_WHILESTMT,
+    /* NoIfStmt -> CompStmt */ NT_COMPSTMT,
+    /* NoIfStmt -> ReturnStmt */ NT_RETURNSTMT,
+    /* NoIfStmt -> Declaration */ NT_DECLARATION,
+    /* NoIfStmt -> OutputStmt */ NT_OUTPUTSTMT,
+    /* NoIfStmt -> InputStmt */ NT_INPUTSTMT,
+    /* NoIfStmt -> Expr :: @exprStmt */ NT_EXPR, TS_TERMINATOR, AS_EXPR_STMT,
+    /* NoIfStmt -> :: @empty */ TS_TERMINATOR, AS_EMPTY,
+    /* ForStmt -> for ( OptExpr :: OptExpr :: OptExpr ) Stmt @for */ TS_FOR, TS_LPAREN, NT_OPTEXPR, TS_TERMINATOR, NT_OPTEXPR, TS_TERMINATOR, NT_OPTEXPR, TS_RPAREN, NT_STMT, AS_FOR,
+    /* OptExpr -> Expr */ NT_EXPR,
+    /* OptExpr -> @empty */ AS_EMPTY,
+    /* WhileStmt -> while ( Expr ) Stmt @while */ TS_WHILE, TS_LPAREN, NT_EXPR, TS_RPAREN, NT_STMT, AS_WHILE,
+    /* IfStmt -> Agar ( @mark Expr ) Stmt ElsePart @if */ TS_AGAR, TS_LPAREN, AS_MARK, NT_EXPR, TS_RPAREN, NT_STMT, NT_ELSEPART, AS_IF,
+    /* ElsePart -> Wagarna Stmt */ TS_WAGARNA, NT_STMT,
+    /* ElsePart -> ^ */
+    /* CompStmt -> { @mark StmtList } @block */ TS_LBRACE, AS_MARK, NT_STMTLIST, TS_RBRACE, AS_BLOCK,
+    /* StmtList -> Stmt StmtList */ NT_STMT, NT_STMTLIST,
+    /* StmtList -> ^ */
+    /* ReturnStmt -> Wapas Expr :: @return */ TS_WAPAS, NT_EXPR, TS_TERMINATOR, AS_RETURN,
+    /* OutputStmt -> output<- Output :: @output */ TS_OUTPUT, NT_OUTPUT, TS_TERMINATOR, AS_OUTPUT,
+    /* Output -> string @string */ TS_STRING, AS_STRING,
+    /* Output -> Expr */ NT_EXPR,
+    /* InputStmt -> input-> identifier @identifier :: @input */ TS_INPUT, TS_IDENTIFIER, AS_IDENTIFIER, TS_TERMINATOR, AS_INPUT,
+    /* Expr -> ( Expr ) */ TS_LPAREN, NT_EXPR, TS_RPAREN,
+    /* Expr -> identifier */ TS_IDENTIFIER,
+    /* Expr -> number */ TS_NUMBER,
+    /* Expr -> True */ TS_TRUE,
+    /* Expr -> False */ TS_FALSE,
+};
+
+const PRODUCTION PRODUCTIONS[] = {
+    {NT_PROGRAMME, 2, 0},
+    {NT_PROGRAMME, 0, 2},
+    {NT_TOPLEVEL, 5, 2},
+    {NT_TOPLEVEL_1, 6, 7},
+    {NT_TOPLEVEL_1, 2, 13},
+    {NT_TYPE, 1, 15},
+    {NT_TYPE, 1, 16},
+    {NT_TYPE, 1, 17},
+    {NT_TYPE, 1, 18},
+    {NT_TYPE, 1, 19},
+    {NT_ARGLIST, 5, 20},
+    {NT_ARGLIST, 0, 25},
+    {NT_ARGLIST_1, 2, 25},
+    {NT_ARGLIST_1, 0, 27},
+    {NT_DECLARATION, 8, 27},
+    {NT_IDENTLIST, 4, 35},
+    {NT_IDENTLIST, 0, 39},
+    {NT_STMT, 1, 39},
+    {NT_STMT, 1, 40},
+    {NT_NOIFSTMT, 1, 41},
+    {NT_NOIFSTMT, 1, 42},
+    {NT_NOIFSTMT, 1, 43},
+    {NT_NOIFSTMT, 1, 44},
+    {NT_NOIFSTMT, 1, 45},
+    {NT_NOIFSTMT, 1, 46},
+    {NT_NOIFSTMT, 1, 47},
+    {NT_NOIFSTMT, 3, 48},
+    {NT_NOIFSTMT, 2, 51},
+    {NT_FORSTMT, 10, 53},
+    {NT_OPTEXPR, 1, 63},
+    {NT_OPTEXPR, 1, 64},
+    {NT_WHILESTMT, 6, 65},
+    {NT_IFSTMT, 8, 71},
+    {NT_ELSEPART, 2, 79},
+    {NT_ELSEPART, 0, 81},
+    {NT_COMPSTMT, 5, 81},
+    {NT_STMTLIST, 2, 86},
+    {NT_STMTLIST, 0, 88},
+    {NT_RETURNSTMT, 4, 88},
+    {NT_OUTPUTSTMT, 4, 92},
+    {NT_OUTPUT, 2, 96},
+    {NT_OUTPUT, 1, 98},
+    {NT_INPUTSTMT, 5, 99},
+    {NT_EXPR, 3, 104},
+    {NT_EXPR, 1, 107},
+    {NT_EXPR, 1, 108},
+    {NT_EXPR, 1, 109},
+    {NT_EXPR, 1, 110},
+};
+
+const uint8_t PARSE_TABLE[NONTERMINAL_COUNT][TERMINAL_COUNT] = {
+    // identifier ( ) :: Adadi Ashriya Harf Matn Mantiqi , for while Agar Wagarna { } Wapas output<- string input-> number True False := == < > <= >= != <> + - * / $ ?
+    /* Programme */ {255, 255, 255, 255, 0, 0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 1, 255},
+    /* TopLevel */ {255, 255, 255, 255, 2, 2, 2, 2, 2, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* TopLevel' */ {255, 3, 255, 4, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* Type */ {255, 255, 255, 255, 5, 6, 7, 8, 9, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* ArgList */ {255, 255, 11, 255, 10, 10, 10, 10, 10, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* ArgList' */ {255, 255, 13, 255, 255, 255, 255, 255, 255, 12, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* Declaration */ {255, 255, 255, 255, 14, 14, 14, 14, 14, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* IdentList */ {255, 255, 255, 16, 255, 255, 255, 255, 255, 15, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* Stmt */ {18, 18, 255, 18, 18, 18, 18, 18, 18, 255, 18, 18, 17, 255, 18, 255, 18, 18, 255, 18, 18, 18, 18, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* NoIfStmt */ {26, 26, 255, 27, 23, 23, 23, 23, 23, 255, 19, 20, 255, 255, 21, 255, 22, 24, 255, 25, 26, 26, 26, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* ForStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 28, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* OptExpr */ {29, 29, 30, 30, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 29, 29, 29, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* WhileStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 31, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* IfStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 32, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* ElsePart */ {34, 34, 255, 34, 34, 34, 34, 34, 34, 255, 34, 34, 34, 33, 34, 34, 34, 34, 255, 34, 34, 34, 34, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* CompStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 35, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* StmtList */ {36, 36, 255, 36, 36, 36, 36, 36, 36, 255, 36, 36, 36, 255, 36, 37, 36, 36, 255, 36, 36, 36, 36, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* ReturnStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 38, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* OutputStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 39, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* Output */ {41, 41, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 40, 255, 41, 41, 41, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* InputStmt */ {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 42, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+    /* Expr */ {44, 43, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 45, 46, 47, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+};
+
+const char* const GRAMMAR_SYMBOL_NAMES[GRAMMAR_SYMBOL_COUNT] = {
+    "identifier",
+    "(",
+    ")",
+    "::",
+    "Adadi",
+    "Ashriya",
+    "Harf",
+    "Matn",
+    "Mantiqi",
+    ",",
+    "for",
+    "while",
+    "Agar",
+    "Wagarna",
+    "{",
+    "}",
+    "Wapas",
+    "output<-",
+    "string",
+    "input->",
+    "number",
+    "True",
+    "False",
+    ":=",
+    "==",
+    "<",
+    ">",
+    "<=",
+    ">=",
+    "!=",
+    "<>",
+    "+",
+    "-",
+    "*",
+    "/",
+    "$",
+    "?",
+    "programme",
+    "topLevel",
+    "topLevel_1",
+    "type",
+    "argList",
+    "argList_1",
+    "declaration",
+    "identList",
+    "stmt",
+    "noIfStmt",
+    "forStmt",
+    "optExpr",
+    "whileStmt",
+    "ifStmt",
+    "elsePart",
+    "compStmt",
+    "stmtList",
+    "returnStmt",
+    "outputStmt",
+    "output",
+    "inputStmt",
+    "expr",
+    "@token",
+    "@mark",
+    "@function",
+    "@global",
+    "@param",
+    "@identifier",
+    "@declaration",
+    "@exprStmt",
+    "@empty",
+    "@for",
+    "@while",
+    "@if",
+    "@block",
+    "@return",
+    "@output",
+    "@string",
+    "@input",
+};
+
+static constexpr std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> buildKindTerminals() {
+    std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> terminals{};
+    for (auto& terminal : terminals) terminal = TS_UNKNOWN;
+    terminals[TK_IDENTIFIER] = TS_IDENTIFIER;
+    terminals[operatorKind("(")] = TS_LPAREN;
+    terminals[operatorKind(")")] = TS_RPAREN;
+    terminals[operatorKind("::")] = TS_TERMINATOR;
+    terminals[lookupKeyword("Adadi")] = TS_ADADI;
+    terminals[lookupKeyword("Ashriya")] = TS_ASHRIYA;
+    terminals[lookupKeyword("Harf")] = TS_HARF;
+    terminals[lookupKeyword("Matn")] = TS_MATN;
+    terminals[lookupKeyword("Mantiqi")] = TS_MANTIQI;
+    terminals[operatorKind(",")] = TS_COMMA;
+    terminals[lookupKeyword("for")] = TS_FOR;
+    terminals[lookupKeyword("while")] = TS_WHILE;
+    terminals[lookupKeyword("Agar")] = TS_AGAR;
+    terminals[lookupKeyword("Wagarna")] = TS_WAGARNA;
+    terminals[operatorKind("{")] = TS_LBRACE;
+    terminals[operatorKind("}")] = TS_RBRACE;
+    terminals[lookupKeyword("Wapas")] = TS_WAPAS;
+    terminals[lookupKeyword("output<-")] = TS_OUTPUT;
+    terminals[TK_STRING] = TS_STRING;
+    terminals[lookupKeyword("input->")] = TS_INPUT;
+    terminals[TK_NUMBER] = TS_NUMBER;
+    terminals[lookupKeyword("True")] = TS_TRUE;
+    terminals[lookupKeyword("False")] = TS_FALSE;
+    terminals[operatorKind(":=")] = TS_ASSIGN;
+    terminals[operatorKind("==")] = TS_EQ;
+    terminals[operatorKind("<")] = TS_LT;
+    terminals[operatorKind(">")] = TS_GT;
+    terminals[operatorKind("<=")] = TS_LE;
+    terminals[operatorKind(">=")] = TS_GE;
+    terminals[operatorKind("!=")] = TS_NE;
+    terminals[operatorKind("<>")] = TS_LTGT;
+    terminals[operatorKind("+")] = TS_PLUS;
+    terminals[operatorKind("-")] = TS_MINUS;
+    terminals[operatorKind("*")] = TS_STAR;
+    terminals[operatorKind("/")] = TS_SLASH;
+    terminals[TK_EOF] = TS_EOF;
+    return terminals;
+}
+
+static_assert(operatorKind("(") != TK_NONE, "grammar terminal ( has no token kind");
+static_assert(operatorKind(")") != TK_NONE, "grammar terminal ) has no token kind");
+static_assert(operatorKind("::") != TK_NONE, "grammar terminal :: has no token kind");
+static_assert(lookupKeyword("Adadi") != TK_NONE, "grammar terminal Adadi has no token kind");
+static_assert(lookupKeyword("Ashriya") != TK_NONE, "grammar terminal Ashriya has no token kind");
+static_assert(lookupKeyword("Harf") != TK_NONE, "grammar terminal Harf has no token kind");
+static_assert(lookupKeyword("Matn") != TK_NONE, "grammar terminal Matn has no token kind");
+static_assert(lookupKeyword("Mantiqi") != TK_NONE, "grammar terminal Mantiqi has no token kind");
+static_assert(operatorKind(",") != TK_NONE, "grammar terminal , has no token kind");
+static_assert(lookupKeyword("for") != TK_NONE, "grammar terminal for has no token kind");
+static_assert(lookupKeyword("while") != TK_NONE, "grammar terminal while has no token kind");
+static_assert(lookupKeyword("Agar") != TK_NONE, "grammar terminal Agar has no token kind");
+static_assert(lookupKeyword("Wagarna") != TK_NONE, "grammar terminal Wagarna has no token kind");
+static_assert(operatorKind("{") != TK_NONE, "grammar terminal { has no token kind");
+static_assert(operatorKind("}") != TK_NONE, "grammar terminal } has no token kind");
+static_assert(lookupKeyword("Wapas") != TK_NONE, "grammar terminal Wapas has no token kind");
+static_assert(lookupKeyword("output<-") != TK_NONE, "grammar terminal output<- has no token kind");
+static_assert(lookupKeyword("input->") != TK_NONE, "grammar terminal input-> has no token kind");
+static_assert(lookupKeyword("True") != TK_NONE, "grammar terminal True has no token kind");
+static_assert(lookupKeyword("False") != TK_NONE, "grammar terminal False has no token kind");
+static_assert(operatorKind(":=") != TK_NONE, "grammar terminal := has no token kind");
+static_assert(operatorKind("==") != TK_NONE, "grammar terminal == has no token kind");
+static_assert(operatorKind("<") != TK_NONE, "grammar terminal < has no token kind");
+static_assert(operatorKind(">") != TK_NONE, "grammar terminal > has no token kind");
+static_assert(operatorKind("<=") != TK_NONE, "grammar terminal <= has no token kind");
+static_assert(operatorKind(">=") != TK_NONE, "grammar terminal >= has no token kind");
+static_assert(operatorKind("!=") != TK_NONE, "grammar terminal != has no token kind");
+static_assert(operatorKind("<>") != TK_NONE, "grammar terminal <> has no token kind");
+static_assert(operatorKind("+") != TK_NONE, "grammar terminal + has no token kind");
+static_assert(operatorKind("-") != TK_NONE, "grammar terminal - has no token kind");
+static_assert(operatorKind("*") != TK_NONE, "grammar terminal * has no token kind");
+static_assert(operatorKind("/") != TK_NONE, "grammar terminal / has no token kind");
+
+const std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> KIND_TERMINALS = buildKindTerminals();
+
+static constexpr std::array<uint8_t, TOKEN_KIND_COUNT> buildBindingPowers() {
+    std::array<uint8_t, TOKEN_KIND_COUNT> powers{};
+    powers[operatorKind(":=")] = 1;
+    powers[operatorKind("==")] = 2;
+    powers[operatorKind("<")] = 2;
+    powers[operatorKind(">")] = 2;
+    powers[operatorKind("<=")] = 2;
+    powers[operatorKind(">=")] = 2;
+    powers[operatorKind("!=")] = 2;
+    powers[operatorKind("<>")] = 2;
+    powers[operatorKind("+")] = 3;
+    powers[operatorKind("-")] = 3;
+    powers[operatorKind("*")] = 4;
+    powers[operatorKind("/")] = 4;
+    return powers;
+}
+
+const std::array<uint8_t, TOKEN_KIND_COUNT> BINDING_POWERS = buildBindingPowers();
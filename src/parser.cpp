@@ -1,289 +1,404 @@
 #include "parser.hpp"
 #include <iostream>
 #include <cstdlib>
-#include <fcntl.h>
-#include <unistd.h>
 
-Parser::Parser(std::vector<TOKEN> _tokens) : tokens(std::move(_tokens)), index(0), depth(0), next_line(false) {
-    parse_tree_fd = open((parse_tree_directory + "/" + parse_tree_filename).c_str(), O_CREAT | O_WRONLY, 0644);
-    if (parse_tree_fd == -1) {
-        std::cerr << "Parser:Parser() unable to open parse tree file\n";
-    }
-}
-
-bool Parser::drawInStart(const std::string& node_name) {
-    ++depth;
-    next_line = true;
-    write(node_name);
-    return true;
-}
+template <typename SINK, typename SOURCE>
+Parser<SINK, SOURCE>::Parser(SOURCE _source) : source(std::move(_source)) {}
 
-bool Parser::drawInEnd() {
-    if (next_line) write("");
-    next_line = false;
-    --depth;
-    return true;
-}
-
-void Parser::write(const std::string& node_name) {
-    std::string line;
-    for (int i = 0; i < depth; ++i) line += '\t';
-    if (!node_name.empty()) {
-        line += node_name + "\n";
-        for (int i = 0; i < depth; ++i) line += '\t';
-        line += "|\n";
-    } else {
-        line += "\n";
+// drops stack entries above stack_size, closing the parse tree nodes they still had open
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::unwindTo(size_t stack_size) {
+    while (stack.size() > stack_size) {
+        if (stack.back().symbol == END_NODES) sink.close(stack.back().ends);
+        stack.pop_back();
     }
-    ::write(parse_tree_fd, line.c_str(), line.size());
 }
 
-TOKEN Parser::peek() {
-    if (index >= tokens.size()) {
-        return TOKEN(-1, std::nullopt, TOKEN_CLASS::T_EOF, 0, 0);
+// panic mode: skip to a token the enclosing statement list (or the top level) can resume at
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::skipTokens(bool top_level) {
+    int depth = 0;  // braces opened while skipping; their contents go with the bad statement
+    while (!source.atEnd()) {
+        GRAMMAR_SYMBOL terminal = peek();
+        if (depth == 0 && PARSE_TABLE[NT_TYPE - TERMINAL_COUNT][terminal] != NO_PRODUCTION) return;
+        if (depth == 0 && terminal == TS_RBRACE && !top_level) return;
+        advance();
+        if (terminal == TS_LBRACE) ++depth;
+        else if (terminal == TS_RBRACE && depth > 0 && --depth == 0) return;
+        else if (terminal == TS_TERMINATOR && depth == 0) return;
     }
-    return tokens[index];
 }
 
-void Parser::match(const std::string& lexeme) {
-    if (peek().t_lexeme == lexeme) {
-        ++index;
-    } else {
-        std::cerr << "[PARSE ERROR] Expected '" << lexeme << "' at line " << peek().line_number << "\n";
-        exit(EXIT_FAILURE);
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::syntaxError(GRAMMAR_SYMBOL symbol, std::string message) {
+    size_t position = source.position();
+    if (recovered_at == NEVER || position >= recovered_at + RESYNC_TOKENS) {
+        errors.push_back({peekLine(), static_cast<uint32_t>(position), std::move(message)});
     }
-}
-
-void Parser::match(TOKEN_CLASS cls) {
-    if (peek().t_class == cls) {
-        ++index;
-    } else {
-        std::cerr << "[PARSE ERROR] Expected token class at line " << peek().line_number << "\n";
-        exit(EXIT_FAILURE);
+    bool stuck = position == recovered_at;
+
+    if ((symbol == NT_STMTLIST || symbol == NT_PROGRAMME) && !source.atEnd()) {
+        // a list met something no item can start with (nor follow it): skip it as one bad item and
+        // carry on with the list. that token is never a place skipTokens stops at, so this always moves
+        skipTokens(symbol == NT_PROGRAMME);
+        reduce(NODE_ERROR, TK_NONE, source.position() ? source.keepPrevious() : 0, 0);
+        stack.push_back({symbol, 0});
+        recovered_at = source.position();
+        return;
     }
-}
-
-
-
-void Parser::programme() {
-    drawInStart("programme");
-    if (peek().t_class != T_EOF) {
-        type(); identifier(); programme_1();
+    // the last recovery got nowhere, so give up on the enclosing construct as well
+    if (stuck && !checkpoints.empty()) {
+        checkpoints.pop_back();
     }
-    drawInEnd();
-}
 
-void Parser::programme_1() {
-    drawInStart("programme_1");
-    if (peek().t_lexeme == "(") {
-        match("("); argList(); match(")"); compStmt(); programme();
-    } else if (peek().t_lexeme == "::") {
-        match("::"); programme();
-    }
-    drawInEnd();
-}
-
-void Parser::type() {
-    drawInStart("type");
-    if (peek().t_lexeme == "Adadi" || peek().t_lexeme == "Ashriya" || peek().t_lexeme == "Harf" || peek().t_lexeme == "Mantiqi") {
-        ++index;
-    } else {
-        std::cerr << "[PARSE ERROR] Expected type at line " << peek().line_number << "\n";
-        exit(EXIT_FAILURE);
-    }
-    drawInEnd();
-}
-
-void Parser::argList() {
-    drawInStart("argList");
-    if (peek().t_lexeme == "Adadi" || peek().t_lexeme == "Ashriya" || peek().t_lexeme == "Harf" || peek().t_lexeme == "Mantiqi") {
-        type(); identifier();
-        if (peek().t_lexeme == ",") {
-            match(","); argList();
+    if (checkpoints.empty()) {
+        // outside any TopLevel: restart Programme at the next top level item
+        unwindTo(0);
+        if (stuck) {
+            if (source.atEnd()) return;
+            advance();
         }
+        skipTokens(true);
+        stack.push_back({START_SYMBOL, 0});
+        recovered_at = source.position();
+        return;
     }
-    drawInEnd();
-}
-
-void Parser::declaration() {
-    drawInStart("declaration");
-    type(); identifier();
-    while (peek().t_lexeme == ",") {
-        match(","); identifier();
-    }
-    match("::");
-    drawInEnd();
-}
-
-void Parser::stmt() {
-    drawInStart("stmt");
-    if (peek().t_lexeme == "Agar") ifStmt();
-    else noIfStmt();
-    drawInEnd();
-}
 
-void Parser::noIfStmt() {
-    drawInStart("noIfStmt");
-    if (peek().t_lexeme == "for") forStmt();
-    else if (peek().t_lexeme == "while") whileStmt();
-    else if (peek().t_lexeme == "{") compStmt();
-    else if (peek().t_lexeme == "Wapas") returnStmt();
-    else if (peek().t_class == Keyword) declaration();
-    else if (peek().t_class == Identifier) { expr(); match("::"); }
-    else if (peek().t_lexeme == "::") match("::");
-    else {
-        std::cerr << "[PARSE ERROR] Invalid statement at line " << peek().line_number << "\n";
-        exit(EXIT_FAILURE);
-    }
-    drawInEnd();
+    CHECKPOINT point = checkpoints.back();
+    skipTokens(point.top_level);
+    unwindTo(point.stack_size);
+    values.resize(point.values);
+    marks.resize(point.marks);
+    saved.resize(point.saved);
+    reduce(NODE_ERROR, TK_NONE, source.position() ? source.keepPrevious() : 0, 0);
+    recovered_at = source.position();
 }
 
-void Parser::forStmt() {
-    drawInStart("forStmt");
-    match("for"); match("("); optExpr(); match("::"); optExpr(); match("::"); optExpr(); match(")"); stmt();
-    drawInEnd();
+template <typename SINK, typename SOURCE>
+GRAMMAR_SYMBOL Parser<SINK, SOURCE>::peek() {
+    return lookahead;
 }
 
-void Parser::optExpr() {
-    drawInStart("optExpr");
-    if (peek().t_class == Identifier) expr();
-    drawInEnd();
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::advance() {
+    source.advance();
+    lookahead = source.atEnd() ? TS_EOF : terminalOf(source.kind());
 }
 
-void Parser::whileStmt() {
-    drawInStart("whileStmt");
-    match("while"); match("("); expr(); match(")"); stmt();
-    drawInEnd();
-}
-
-void Parser::ifStmt() {
-    drawInStart("ifStmt");
-    match("Agar"); match("("); expr(); match(")");
-    stmt();
-    if (peek().t_lexeme == "Wagarna"){
-        elsePart();
+template <typename SINK, typename SOURCE>
+std::string_view Parser<SINK, SOURCE>::peekLexeme() {
+    if (source.atEnd()) {
+        return "end of file";
     }
-    drawInEnd();
-}
-void Parser::elsePart() {
-    drawInStart("elsePart");
-    match("Wagarna");
-    stmt();
-    drawInEnd();
+    return source.lexeme();
 }
 
-void Parser::compStmt() {
-    drawInStart("compStmt");
-    match("{"); stmtList(); match("}");
-    drawInEnd();
+template <typename SINK, typename SOURCE>
+uint32_t Parser<SINK, SOURCE>::peekLine() {
+    return source.line();
 }
 
-void Parser::stmtList() {
-    drawInStart("stmtList");
-    if (peek().t_lexeme != "}") {
-        stmt(); stmtList();
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::match(GRAMMAR_SYMBOL terminal) {
+    if (peek() != terminal) {
+        syntaxError(terminal, "[PARSE ERROR] Expected '" + std::string(GRAMMAR_SYMBOL_NAMES[terminal]) + "'");
+        return;
     }
-    drawInEnd();
-}
-
-void Parser::returnStmt() {
-    drawInStart("returnStmt");
-    match("Wapas"); expr(); match("::");
-    drawInEnd();
+    // identifiers, numbers and strings are the only tokens that show up in the tree
+    if (terminal == TS_IDENTIFIER || terminal == TS_NUMBER || terminal == TS_STRING) {
+        sink.leaf(terminal);
+    }
+    advance();
 }
 
-void Parser::expr() {
-    drawInStart("expr");
-    if (peek().t_class == Identifier) {
-        identifier(); expr_1();
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::expand(GRAMMAR_SYMBOL nonterminal) {
+    uint8_t production = PARSE_TABLE[nonterminal - TERMINAL_COUNT][peek()];
+    if (nonterminal == NT_EXPR) {
+        expression();
+        return;
+    }
+    if (production == NO_PRODUCTION) {
+        syntaxError(nonterminal, "[PARSE ERROR] Unexpected '" + std::string(peekLexeme()) + "' in "
+                                 + GRAMMAR_SYMBOL_NAMES[nonterminal]);
+        return;
     }
-    else rvalue();
-    drawInEnd();
-}
 
-void Parser::expr_1() {
-    drawInStart("expr_1");
-    if (peek().t_lexeme == ":=") {
-        match(":="); expr();
-    } else {
-        rvalue_1();
+    if (nonterminal == NT_STMT || nonterminal == NT_TOPLEVEL) {
+        stack.push_back({END_CHECKPOINT, 0});
+        checkpoints.push_back({static_cast<uint32_t>(stack.size()), static_cast<uint32_t>(values.size()),
+                               static_cast<uint32_t>(marks.size()), static_cast<uint32_t>(saved.size()),
+                               nonterminal == NT_TOPLEVEL});
     }
-    drawInEnd();
-}
 
-void Parser::rvalue() {
-    drawInStart("rvalue");
-    mag(); rvalue_1();
-    drawInEnd();
-}
+    if constexpr (SINK::ENABLED) {
+        sink.open(nonterminal);
+        // nodes that close at the same point share one entry, so right recursion does not grow the stack
+        if (!stack.empty() && stack.back().symbol == END_NODES) ++stack.back().ends;
+        else stack.push_back({END_NODES, 1});
+    }
 
-void Parser::rvalue_1() {
-    drawInStart("rvalue_1");
-    if (peek().t_lexeme == "==" || peek().t_lexeme == "<" || peek().t_lexeme == ">" ||
-        peek().t_lexeme == "<=" || peek().t_lexeme == ">=" || peek().t_lexeme == "!=" ||
-        peek().t_lexeme == "<>") {
-        compare(); mag(); rvalue_1();
+    const PRODUCTION& rule = PRODUCTIONS[production];
+    for (int i = rule.length - 1; i >= 0; --i) {
+        stack.push_back({PRODUCTION_SYMBOLS[rule.first + i], 0});
     }
-    drawInEnd();
 }
 
-void Parser::mag() {
-    drawInStart("mag");
-    term(); mag_1();
-    drawInEnd();
-}
+// pops the top count finished nodes and makes them the children of a new node
+template <typename SINK, typename SOURCE>
+uint32_t Parser<SINK, SOURCE>::reduce(NODE_KIND kind, TOKEN_KIND op, uint32_t token, uint32_t count) {
+    uint32_t node = ast.add(kind, op, token, values.data() + values.size() - count, count);
+    values.resize(values.size() - count);
+    values.push_back(node);
+    return node;
+}
+
+template <typename SINK, typename SOURCE>
+uint32_t Parser<SINK, SOURCE>::childrenSinceMark() {
+    uint32_t start = marks.back();
+    marks.pop_back();
+    return values.size() - start;
+}
+
+template <typename SINK, typename SOURCE>
+uint32_t Parser<SINK, SOURCE>::popSaved() {
+    uint32_t token = saved.back();
+    saved.pop_back();
+    return token;
+}
+
+// builds the node for the operator on top of the climbing stack from the top two values
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::reduceOperator() {
+    PENDING_OPERATOR op = operators.back();
+    operators.pop_back();
+    if (op.kind == TK_ASSIGN) reduce(NODE_ASSIGN, TK_ASSIGN, ast[values[values.size() - 2]].token, 2);
+    else reduce(NODE_BINARY, op.kind, op.token, 2);
+}
+
+/*
+ * Expr by precedence climbing, without recursion: operands go straight onto the value
+ * stack, operators and open brackets wait on `operators` until something that binds
+ * less tightly (or the end of the expression) arrives. one AST node per operand and
+ * per operator; brackets leave no trace. a call's bracket waits there too, as TK_IDENTIFIER
+ * with the function's name, and its arguments are the values above the mark it pushed.
+ */
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::expression() {
+    operators.clear();
+    bool expect_operand = true;
+    bool expression_start = true;       // at the start of an Expr, where an identifier may be assigned to
+    bool leading_identifier = false;    // the operand just read was such an identifier
+    while (true) {
+        if (expect_operand) {
+            GRAMMAR_SYMBOL terminal = peek();
+            if (terminal == TS_LPAREN) {
+                advance();
+                operators.push_back({0, TK_LPAREN, 0});
+                expression_start = true;
+                continue;
+            }
+            if (terminal == TS_RPAREN && !operators.empty() && operators.back().kind == TK_IDENTIFIER
+                && marks.back() == values.size()) {
+                // f_n(): a call without arguments
+                expect_operand = false;
+                continue;
+            }
+            if (terminal == TS_TRUE || terminal == TS_FALSE) {
+                advance();
+                reduce(NODE_BOOLEAN, terminal == TS_TRUE ? KW_TRUE : KW_FALSE, source.keepPrevious(), 0);
+            } else if (terminal == TS_IDENTIFIER || terminal == TS_NUMBER) {
+                advance();
+                uint32_t token = source.keepPrevious();
+                if (terminal == TS_IDENTIFIER && peek() == TS_LPAREN) {
+                    advance();
+                    operators.push_back({token, TK_IDENTIFIER, 0});
+                    marks.push_back(values.size());
+                    expression_start = true;
+                    continue;
+                }
+                reduce(terminal == TS_IDENTIFIER ? NODE_IDENTIFIER : NODE_NUMBER, TK_NONE, token, 0);
+            } else {
+                syntaxError(NT_EXPR, "[PARSE ERROR] Unexpected '" + std::string(peekLexeme()) + "' in "
+                                     + GRAMMAR_SYMBOL_NAMES[NT_EXPR]);
+                return;
+            }
+            leading_identifier = expression_start && terminal == TS_IDENTIFIER;
+            expression_start = false;
+            expect_operand = false;
+            continue;
+        }
 
-void Parser::mag_1() {
-    drawInStart("mag_1");
-    if (peek().t_lexeme == "+" || peek().t_lexeme == "-") {
-        match(peek().t_lexeme.value()); term(); mag_1();
-    }
-    drawInEnd();
-}
+        TOKEN_KIND kind = source.atEnd() ? TK_EOF : source.kind();
+        uint8_t power = BINDING_POWERS[kind];
+        // after a leading identifier only := or a comparison, and := nowhere else
+        bool applies = power != 0 && (leading_identifier ? kind == TK_ASSIGN || power == BINDING_POWERS[TK_EQ]
+                                                          : kind != TK_ASSIGN);
+        if (applies) {
+            while (!operators.empty() && operators.back().kind != TK_LPAREN
+                   && (operators.back().power > power || (operators.back().power == power && !isRightAssociative(power)))) {
+                reduceOperator();
+            }
+            advance();
+            operators.push_back({source.keepPrevious(), kind, power});
+            expression_start = kind == TK_ASSIGN;
+            leading_identifier = false;
+            expect_operand = true;
+            continue;
+        }
 
-void Parser::term() {
-    drawInStart("term");
-    factor(); term_1();
-    drawInEnd();
-}
+        // the innermost Expr ends here: finish it, and close its bracket if it has one
+        while (!operators.empty() && operators.back().kind != TK_LPAREN && operators.back().kind != TK_IDENTIFIER) {
+            reduceOperator();
+        }
+        if (operators.empty()) break;
+        bool call = operators.back().kind == TK_IDENTIFIER;
+        if (call && peek() == TS_COMMA) {
+            advance();
+            expression_start = true;
+            expect_operand = true;
+            continue;
+        }
+        if (peek() != TS_RPAREN) {
+            syntaxError(TS_RPAREN, "[PARSE ERROR] Expected ')'");
+            return;
+        }
+        advance();
+        if (call) reduce(NODE_CALL, TK_NONE, operators.back().token, childrenSinceMark());
+        operators.pop_back();
+        leading_identifier = false;
+    }
 
-void Parser::term_1() {
-    drawInStart("term_1");
-    if (peek().t_lexeme == "*" || peek().t_lexeme == "/") {
-        match(peek().t_lexeme.value()); factor(); term_1();
+    if constexpr (SINK::ENABLED) {
+        emitExpression(values.back());
     }
-    drawInEnd();
 }
 
-void Parser::compare() {
-    drawInStart("compare");
-    match(peek().t_lexeme.value());
-    drawInEnd();
+// hands a finished expression to the sink as expr > operator > operand nodes, walking the AST iteratively
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::emitExpression(uint32_t root) {
+    sink.open(NT_EXPR);
+    walk.clear();
+    walk.push_back(root);
+    while (!walk.empty()) {
+        uint32_t entry = walk.back();
+        walk.pop_back();
+        if (entry == AST::NO_NODE) {
+            sink.close(1);
+            continue;
+        }
+        const AST_NODE& node = ast[entry];
+        if (node.kind == NODE_IDENTIFIER || node.kind == NODE_NUMBER) {
+            sink.leaf(node.kind == NODE_IDENTIFIER ? TS_IDENTIFIER : TS_NUMBER);
+            continue;
+        }
+        if (node.kind == NODE_BOOLEAN) {
+            sink.leaf(terminalOf(node.op));
+            continue;
+        }
+        sink.open(node.kind == NODE_CALL ? TS_IDENTIFIER : terminalOf(node.op));
+        walk.push_back(AST::NO_NODE);
+        AST::CHILDREN children = ast.children(entry);
+        for (uint32_t i = children.size(); i-- > 0;) walk.push_back(children[i]);
+    }
+    sink.close(1);
+}
+
+template <typename SINK, typename SOURCE>
+void Parser<SINK, SOURCE>::act(GRAMMAR_SYMBOL action) {
+    // every action runs right after the token it refers to has been matched
+    const TokenStream& tokens = source.stream();
+    switch (action) {
+        case AS_TOKEN: saved.push_back(source.keepPrevious()); break;
+        case AS_MARK: marks.push_back(values.size()); break;
+        case AS_IDENTIFIER: reduce(NODE_IDENTIFIER, TK_NONE, source.keepPrevious(), 0); break;
+        case AS_PARAM: {
+            uint32_t name = source.keepPrevious();
+            reduce(NODE_PARAM, tokens.kind(popSaved()), name, 0);
+            break;
+        }
+        case AS_FUNCTION: {
+            uint32_t name = popSaved();
+            reduce(NODE_FUNCTION, tokens.kind(popSaved()), name, childrenSinceMark());
+            break;
+        }
+        case AS_GLOBAL: {
+            uint32_t name = popSaved();
+            reduce(NODE_IDENTIFIER, TK_NONE, name, 0);
+            reduce(NODE_DECLARATION, tokens.kind(popSaved()), source.keepPrevious(), 1);
+            break;
+        }
+        case AS_DECLARATION: {
+            uint32_t count = childrenSinceMark();
+            reduce(NODE_DECLARATION, tokens.kind(popSaved()), source.keepPrevious(), count);
+            break;
+        }
+        case AS_BLOCK: reduce(NODE_BLOCK, TK_NONE, source.keepPrevious(), childrenSinceMark()); break;
+        case AS_IF: reduce(NODE_IF, TK_NONE, source.keepPrevious(), childrenSinceMark()); break;
+        case AS_WHILE: reduce(NODE_WHILE, TK_NONE, source.keepPrevious(), 2); break;
+        case AS_FOR: reduce(NODE_FOR, TK_NONE, source.keepPrevious(), 4); break;
+        case AS_RETURN: reduce(NODE_RETURN, TK_NONE, source.keepPrevious(), 1); break;
+        case AS_EXPR_STMT: reduce(NODE_EXPR_STMT, TK_NONE, source.keepPrevious(), 1); break;
+        case AS_EMPTY: reduce(NODE_EMPTY, TK_NONE, source.keepPrevious(), 0); break;
+        case AS_STRING: reduce(NODE_STRING, TK_NONE, source.keepPrevious(), 0); break;
+        case AS_OUTPUT: reduce(NODE_OUTPUT, TK_NONE, source.keepPrevious(), 1); break;
+        case AS_INPUT: reduce(NODE_INPUT, TK_NONE, source.keepPrevious(), 1); break;
+        default:
+            std::cerr << "Parser:act() no action for " << GRAMMAR_SYMBOL_NAMES[action] << "\n";
+            exit(EXIT_FAILURE);
+    }
 }
 
-void Parser::factor() {
-    drawInStart("factor");
-    if (peek().t_lexeme == "(") {
-        match("("); expr(); match(")");
-    } else if (peek().t_class == Identifier) {
-        identifier();
-    } else if (peek().t_class == Number) {
-        number();
-    } else {
-        std::cerr << "[PARSE ERROR] Invalid factor at line " << peek().line_number << "\n";
-        exit(EXIT_FAILURE);
+template <typename SINK, typename SOURCE>
+bool Parser<SINK, SOURCE>::programme() {
+    source.start();
+    lookahead = source.atEnd() ? TS_EOF : terminalOf(source.kind());
+    stack.clear();
+    stack.push_back({START_SYMBOL, 0});
+    ast.reset();
+    ast.reserve(source.sizeHint() + 1);
+    values.clear();
+    marks.clear();
+    saved.clear();
+    errors.clear();
+    checkpoints.clear();
+    recovered_at = NEVER;
+    while (!stack.empty()) {
+        STACK_ENTRY top = stack.back();
+        stack.pop_back();
+        GRAMMAR_SYMBOL symbol = static_cast<GRAMMAR_SYMBOL>(top.symbol);
+        if (top.symbol == END_NODES) sink.close(top.ends);
+        else if (top.symbol == END_CHECKPOINT) checkpoints.pop_back();
+        else if (isTerminal(symbol)) match(symbol);
+        else if (isAction(symbol)) act(symbol);
+        else expand(symbol);
+    }
+    // whatever is left are the top level functions and declarations
+    reduce(NODE_PROGRAMME, TK_NONE, source.position() ? source.keepPrevious() : 0, values.size());
+    return errors.empty();
+}
+
+std::vector<uint32_t> splitTopLevel(const TokenStream& tokens) {
+    std::vector<uint32_t> starts;
+    if (tokens.empty()) return starts;
+    starts.push_back(0);
+    int depth = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        TOKEN_KIND kind = tokens.kind(i);
+        if (kind == TK_LBRACE) ++depth;
+        else if (kind == TK_RBRACE && depth > 0 && --depth == 0) starts.push_back(i + 1);
+        else if (kind == TK_TERMINATOR && depth == 0) starts.push_back(i + 1);
     }
-    drawInEnd();
+    return starts;
 }
 
-void Parser::identifier() {
-    drawInStart("Identifier");
-    match(Identifier);
-    drawInEnd();
+std::string DIAGNOSTIC::toString() const {
+    return line == 0 ? message + " at end of file" : message + " at line " + std::to_string(line);
 }
 
-void Parser::number() {
-    drawInStart("Number");
-    match(Number);
-    drawInEnd();
-}
\ No newline at end of file
+template class Parser<NULL_SINK, STREAM_SOURCE>;
+template class Parser<TEXT_SINK, STREAM_SOURCE>;
+template class Parser<BINARY_SINK, STREAM_SOURCE>;
+template class Parser<NULL_SINK, RING_SOURCE>;
+template class Parser<TEXT_SINK, RING_SOURCE>;
+template class Parser<BINARY_SINK, RING_SOURCE>;
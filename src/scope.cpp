@@ -0,0 +1,88 @@
+#include "scope.hpp"
+
+void SCOPE_TABLE::enter() {
+    scopes.push_back(static_cast<uint32_t>(undo.size()));
+}
+
+void SCOPE_TABLE::exit() {
+    for (size_t mark = scopes.back(); undo.size() > mark; undo.pop_back()) {
+        bindings[undo.back().name] = undo.back().symbol;
+    }
+    scopes.pop_back();
+}
+
+uint32_t SCOPE_TABLE::declare(uint32_t name, DATA_TYPE type, uint32_t node) {
+    if (name >= bindings.size()) {
+        bindings.resize(name + 1, NO_SYMBOL);
+    }
+    undo.push_back({name, bindings[name]});
+    all.push_back({name, type, node, depth()});
+    return bindings[name] = static_cast<uint32_t>(all.size() - 1);
+}
+
+void SCOPE_TABLE::reset() {
+    bindings.clear();
+    undo.clear();
+    scopes.clear();
+    all.clear();
+}
+
+NAME_BINDINGS bindNames(const AST& tree, const TokenStream& tokens) {
+    NAME_BINDINGS result;
+    SCOPE_TABLE& scopes = result.scopes;
+    result.node_symbols.assign(tree.size(), SCOPE_TABLE::NO_SYMBOL);
+    if (tree.empty())
+        return result;
+
+    auto declare = [&](uint32_t node, uint32_t token, DATA_TYPE type) {
+        uint32_t name = tokens.id(token);
+        if (scopes.declaredHere(name))
+            result.redeclared.push_back(node);
+        result.node_symbols[node] = scopes.declare(name, type, node);
+    };
+
+    // pre-order walk; EXIT_SCOPE entries close the scope a function or block opened
+    static constexpr uint32_t EXIT_SCOPE = AST::NO_NODE;
+    std::vector<uint32_t> walk{tree.root()};
+    while (!walk.empty()) {
+        uint32_t node = walk.back();
+        walk.pop_back();
+        if (node == EXIT_SCOPE) {
+            scopes.exit();
+            continue;
+        }
+        const AST_NODE& n = tree[node];
+        AST::CHILDREN children = tree.children(node);
+        switch (n.kind) {
+            case NODE_FUNCTION:
+                declare(node, n.token, dataTypeOf(n.op));
+                scopes.enter();
+                walk.push_back(EXIT_SCOPE);
+                break;
+            case NODE_BLOCK:
+                scopes.enter();
+                walk.push_back(EXIT_SCOPE);
+                break;
+            case NODE_PARAM:
+                declare(node, n.token, dataTypeOf(n.op));
+                break;
+            case NODE_DECLARATION:
+                for (uint32_t name : children) {
+                    declare(name, tree[name].token, dataTypeOf(n.op));
+                }
+                continue;
+            case NODE_IDENTIFIER:
+            case NODE_CALL:
+                result.node_symbols[node] = scopes.lookup(tokens.id(n.token));
+                if (result.node_symbols[node] == SCOPE_TABLE::NO_SYMBOL)
+                    result.undeclared.push_back(node);
+                break;
+            default:
+                break;
+        }
+        for (uint32_t i = children.size(); i-- > 0;) {
+            walk.push_back(children[i]);
+        }
+    }
+    return result;
+}
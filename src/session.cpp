@@ -0,0 +1,303 @@
+#include "session.hpp"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+static uint32_t countLines(std::string_view text) {
+    return std::count(text.begin(), text.end(), '\n');
+}
+
+std::unique_ptr<UNIT> Session::parseUnit(std::string text, size_t offset, uint32_t line) {
+    auto unit = std::make_unique<UNIT>();
+    unit->offset = offset;
+    unit->line = line;
+    unit->lexer.emplace(std::move(text), symbol_table, literal_table);
+    parse(*unit);
+    return unit;
+}
+
+void Session::parse(UNIT& unit) {
+    unit.lex_errors.clear();
+    for (const IncrementalLexer::LEX_ERROR& error : unit.lexer->errors()) {
+        unit.lex_errors += error.message + "\n";
+    }
+    unit.parser.emplace(STREAM_SOURCE(TokenStream(unit.lexer->tokens())));
+    unit.parser->programme();
+}
+
+/*
+ * true if unit, whose tokens have just changed, is still exactly one unit: it starts with
+ * a token, and it holds one top level item that ends on a boundary with the lexer not
+ * running off its end, unless it is the last unit, whose text may run on to the end.
+ */
+static bool standsAlone(const UNIT& unit, bool last) {
+    const TokenStream& tokens = unit.lexer->tokens();
+    if (tokens.empty() || tokens.offset(0) != 0)
+        return false;
+    std::vector<uint32_t> starts = splitTopLevel(tokens);
+    bool boundary_at_end = starts.back() == tokens.size();
+    if (boundary_at_end)
+        starts.pop_back();
+    return starts.size() == 1 && (last || (boundary_at_end && unit.lexer->endedClean()));
+}
+
+/*
+ * splits text, which starts on a unit boundary, into units. text is lexed once here to find
+ * the boundaries and again unit by unit, so that each unit owns its tokens and lex errors.
+ * a unit boundary is the first token after a top level item, so text that does not start
+ * with a token belongs to the unit before it, and text that does not end on a boundary
+ * runs on into the unit after it.
+ */
+std::vector<std::unique_ptr<UNIT>> Session::build(const std::string& text, size_t offset, uint32_t line,
+                                                  bool& clean_start, bool& clean_end) {
+    std::ostream discard(nullptr);
+    Lexer lex(text, symbol_table, literal_table, discard);
+    TokenStream tokens(text);
+    while (!lex.isEmpty()) {
+        TOKEN token = lex.getNextToken();
+        if (token.t_class == TOKEN_CLASS::T_EOF)
+            break;
+        tokens.push_back(token);
+    }
+    std::vector<uint32_t> starts = splitTopLevel(tokens);
+    bool boundary_at_end = !starts.empty() && starts.back() == tokens.size();
+    if (boundary_at_end)
+        starts.pop_back();
+    clean_start = !tokens.empty() && tokens[0].t_offset == 0;
+    clean_end = boundary_at_end && lex.endedClean();
+
+    std::vector<std::unique_ptr<UNIT>> units;
+    size_t begin = 0;
+    for (size_t i = 0; i < std::max<size_t>(starts.size(), 1); ++i) {
+        size_t end = i + 1 < starts.size() ? tokens[starts[i + 1]].t_offset : text.size();
+        units.push_back(parseUnit(text.substr(begin, end - begin), offset + begin, line));
+        line += countLines(units.back()->text());
+        begin = end;
+    }
+    return units;
+}
+
+size_t Session::errorsIn(const UNIT& unit) {
+    return unit.parser->diagnostics().size() + countLines(unit.lex_errors);
+}
+
+void Session::load(std::string_view text) {
+    bool clean_start, clean_end;
+    unit_list = build(std::string(text), 0, 1, clean_start, clean_end);
+    shift_from = SIZE_MAX;
+    shift_offset = shift_lines = 0;
+    error_count = 0;
+    for (const auto& unit : unit_list) {
+        error_count += errorsIn(*unit);
+    }
+}
+
+bool Session::load(const char* filename) {
+    BUFFER input(filename);
+    if (!input.isLoaded())
+        return false;
+    load(std::string_view(input.data(), input.size()));
+    return true;
+}
+
+/*index of the unit holding byte offset; the last unit for offsets at or past the end*/
+size_t Session::unitAt(size_t offset) const {
+    size_t low = 0, high = unit_list.size();
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (offsetOf(middle) <= offset) low = middle;
+        else high = middle;
+    }
+    return low;
+}
+
+void Session::shift(size_t from, size_t to, int64_t offset, int64_t lines) {
+    for (size_t i = from; i < to; ++i) {
+        unit_list[i]->offset += offset;
+        unit_list[i]->line += lines;
+    }
+}
+
+const std::vector<std::unique_ptr<UNIT>>& Session::units() {
+    if (shift_from < unit_list.size())
+        shift(shift_from, unit_list.size(), shift_offset, shift_lines);
+    shift_from = SIZE_MAX;
+    shift_offset = shift_lines = 0;
+    return unit_list;
+}
+
+Session::EDIT_STATS Session::edit(size_t offset, size_t length, std::string_view text) {
+    offset = std::min(offset, size());
+    length = std::min(length, size() - offset);
+
+    // the unit before the edit is damaged too: text typed at its end may join its last token
+    size_t first = unitAt(offset ? offset - 1 : 0);
+    size_t last = unitAt(offset + length);
+    std::string region;
+    size_t old_size = 0;
+    uint32_t old_lines = 0;
+    for (size_t i = first; i <= last; ++i) {
+        old_size += unit_list[i]->text().size();
+        old_lines += countLines(unit_list[i]->text());
+    }
+
+    if (first == last && offset + length < offsetOf(first) + old_size) {
+        // inside one unit: its lexer re-lexes around the edit, and the unit is parsed again
+        // on its own unless the edit changed where units start
+        UNIT& unit = *unit_list[first];
+        size_t relexed = unit.lexer->edit(offset - offsetOf(first), length, text).inserted;
+        if (standsAlone(unit, first + 1 == unit_list.size())) {
+            error_count -= errorsIn(unit);
+            parse(unit);
+            error_count += errorsIn(unit);
+            replace(first, last, {}, static_cast<int64_t>(unit.text().size()) - static_cast<int64_t>(old_size),
+                    static_cast<int64_t>(countLines(unit.text())) - old_lines);
+            return {1, relexed};
+        }
+        region = std::string(unit.text());
+    } else {
+        for (size_t i = first; i <= last; ++i) {
+            region += unit_list[i]->text();
+        }
+        region.replace(offset - offsetOf(first), length, text);
+    }
+
+    std::vector<std::unique_ptr<UNIT>> units;
+    for (size_t grow = 1;; grow *= 2) {
+        bool clean_start, clean_end;
+        units = build(region, offsetOf(first), lineOf(first), clean_start, clean_end);
+        if (!clean_start && first > 0) {
+            region.insert(0, unit_list[--first]->text());
+            old_size += unit_list[first]->text().size();
+            old_lines += countLines(unit_list[first]->text());
+            continue;
+        }
+        if (clean_end || last + 1 == unit_list.size())
+            break;
+        for (size_t end = std::min(unit_list.size(), last + 1 + grow); last + 1 < end;) {
+            region += unit_list[++last]->text();
+            old_size += unit_list[last]->text().size();
+            old_lines += countLines(unit_list[last]->text());
+        }
+    }
+
+    EDIT_STATS stats;
+    stats.units = units.size();
+    uint32_t new_lines = 0;
+    for (size_t i = first; i <= last; ++i) {
+        error_count -= errorsIn(*unit_list[i]);
+    }
+    for (const auto& unit : units) {
+        new_lines += countLines(unit->text());
+        error_count += errorsIn(*unit);
+        stats.tokens += unit->tokenCount();
+    }
+    replace(first, last, std::move(units), static_cast<int64_t>(region.size()) - static_cast<int64_t>(old_size),
+            static_cast<int64_t>(new_lines) - old_lines);
+    return stats;
+}
+
+void Session::replace(size_t first, size_t last, std::vector<std::unique_ptr<UNIT>> units, int64_t size_change,
+                      int64_t line_change) {
+    size_t count = units.empty() ? last + 1 - first : units.size();
+
+    // move the pending shift to just after the region, settling the units it passes over,
+    // kept ones in the region included
+    size_t settle_to = units.empty() ? last + 1 : first;
+    if (shift_from < settle_to) {
+        shift(shift_from, settle_to, shift_offset, shift_lines);
+    } else if (shift_from != SIZE_MAX && shift_from > last + 1) {
+        shift(last + 1, shift_from, -shift_offset, -shift_lines);
+    }
+    shift_from = first + count;
+    shift_offset += size_change;
+    shift_lines += line_change;
+
+    if (units.empty())
+        return;
+    if (units.size() == last + 1 - first) {
+        std::move(units.begin(), units.end(), unit_list.begin() + first);
+    } else {
+        unit_list.erase(unit_list.begin() + first, unit_list.begin() + last + 1);
+        unit_list.insert(unit_list.begin() + first, std::make_move_iterator(units.begin()), std::make_move_iterator(units.end()));
+    }
+}
+
+static void printErrors(Session& session) {
+    for (const auto& unit : session.units()) {
+        std::cout << unit->lex_errors;
+        for (const DIAGNOSTIC& diagnostic : unit->parser->diagnostics()) {
+            DIAGNOSTIC located{unit->documentLine(diagnostic), diagnostic.token, diagnostic.message};
+            std::cout << located.toString() << "\n";
+        }
+    }
+    std::cout << "." << std::endl;
+}
+
+static void printUnits(Session& session) {
+    for (const auto& unit : session.units()) {
+        std::cout << unit->line << " " << unit->offset << " " << unit->text().size() << " "
+                  << unit->tokenCount() << " " << unit->parser->tree().size() << "\n";
+    }
+    std::cout << "." << std::endl;
+}
+
+// edits are typed or pasted, so a count past this is a mistake rather than text on its way
+static constexpr size_t MAX_EDIT_BYTES = size_t(1) << 30;
+
+/*reads bytes bytes into text a block at a time, so a count the input does not back costs nothing up front*/
+static bool readText(std::istream& in, size_t bytes, std::string& text) {
+    static constexpr size_t BLOCK = 64 * 1024;
+    text.clear();
+    while (text.size() < bytes) {
+        size_t used = text.size();
+        size_t want = std::min(BLOCK, bytes - used);
+        text.resize(used + want);
+        if (!in.read(&text[used], want))
+            return false;
+    }
+    return true;
+}
+
+int serve(const char* filename) {
+    Session session;
+    if (!session.load(filename)) {
+        std::cerr << "unable to read " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "loaded " << session.units().size() << " units, " << session.errorCount() << " errors" << std::endl;
+
+    std::string command;
+    while (std::cin >> command) {
+        if (command == "edit") {
+            size_t offset, length, bytes;
+            if (!(std::cin >> offset >> length >> bytes) || std::cin.get() != '\n') {
+                std::cout << "error expected edit <offset> <length> <bytes>" << std::endl;
+                return EXIT_FAILURE;
+            }
+            if (bytes > MAX_EDIT_BYTES) {
+                std::cout << "error edit of " << bytes << " bytes is larger than " << MAX_EDIT_BYTES << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string text;
+            if (!readText(std::cin, bytes, text)) {
+                std::cout << "error expected " << bytes << " bytes of text" << std::endl;
+                return EXIT_FAILURE;
+            }
+            auto start = std::chrono::steady_clock::now();
+            Session::EDIT_STATS stats = session.edit(offset, length, text);
+            auto stop = std::chrono::steady_clock::now();
+            std::cout << "ok " << stats.units << " " << stats.tokens << " " << session.errorCount() << " "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "us" << std::endl;
+        } else if (command == "errors") {
+            printErrors(session);
+        } else if (command == "units") {
+            printUnits(session);
+        } else if (command == "quit") {
+            break;
+        } else {
+            std::cout << "error unknown command " << command << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
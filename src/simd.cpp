@@ -0,0 +1,376 @@
+#include "simd.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+static inline bool isWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static size_t findSpecialScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && p[i] != '/' && !isWhitespace(p[i])) ++i;
+    return i;
+}
+
+static size_t skipWhitespaceScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && isWhitespace(p[i])) ++i;
+    return i;
+}
+
+static size_t findLineEndScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && p[i] != '\n') ++i;
+    return i;
+}
+
+static size_t findBlockEndScalar(const char* p, size_t n) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+        if (p[i] == '*' && p[i + 1] == '/') return i;
+    }
+    return n;
+}
+
+static inline bool isDigitByte(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool isAlnumByte(char c) {
+    return isDigitByte(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static inline bool isStringByte(char c) {
+    return c != '"' && (static_cast<signed char>(c) >= 32 || c == '\t' || c == '\n' || c == '\r');
+}
+
+static size_t skipAlnumScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && isAlnumByte(p[i])) ++i;
+    return i;
+}
+
+static size_t skipIdentifierTailScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && (isAlnumByte(p[i]) || p[i] == '-')) ++i;
+    return i;
+}
+
+static size_t skipDigitsScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && isDigitByte(p[i])) ++i;
+    return i;
+}
+
+static size_t skipStringBodyScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && isStringByte(p[i])) ++i;
+    return i;
+}
+
+const SCAN_KERNELS& scalarKernels() {
+    static const SCAN_KERNELS kernels{
+        "scalar", findSpecialScalar, skipWhitespaceScalar, findLineEndScalar, findBlockEndScalar,
+        skipAlnumScalar, skipIdentifierTailScalar, skipDigitsScalar, skipStringBodyScalar
+    };
+    return kernels;
+}
+
+#ifdef SIMD_X86
+
+/*SSE2: 16 bytes per step; part of the x86-64 baseline so it needs no target attribute*/
+
+static inline __m128i whitespace128(__m128i v) {
+    // '\t'..'\r' as one unsigned range check: (v - 9) <= 4
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    return _mm_or_si128(in_range, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+static size_t findSpecialSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(whitespace128(v), _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+        unsigned mask = _mm_movemask_epi8(hit);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findSpecialScalar(p + i, n - i);
+}
+
+static size_t skipWhitespaceSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = ~_mm_movemask_epi8(whitespace128(v)) & 0xFFFFu;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipWhitespaceScalar(p + i, n - i);
+}
+
+static size_t findLineEndSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findLineEndScalar(p + i, n - i);
+}
+
+static size_t findBlockEndSse2(const char* p, size_t n) {
+    size_t i = 0;
+    // the second load is shifted by one byte so '*' and the following '/' line up
+    for (; i + 17 <= n; i += 16) {
+        __m128i star = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i slash = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 1));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(star, _mm_set1_epi8('*')), _mm_cmpeq_epi8(slash, _mm_set1_epi8('/')));
+        unsigned mask = _mm_movemask_epi8(hit);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findBlockEndScalar(p + i, n - i);
+}
+
+// unsigned lo <= v <= hi, per byte
+static inline __m128i inRange128(__m128i v, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(hi - lo)), shifted);
+}
+
+static inline __m128i alnum128(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    return _mm_or_si128(inRange128(v, '0', '9'), inRange128(lower, 'a', 'z'));
+}
+
+// positions where the string body ends: '"', or a control/non-ASCII byte other than \t, \n, \r
+static inline __m128i stringEnd128(__m128i v) {
+    __m128i control = _mm_cmplt_epi8(v, _mm_set1_epi8(32));
+    __m128i allowed = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    return _mm_or_si128(_mm_andnot_si128(allowed, control), _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+}
+
+static size_t skipAlnumSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = ~_mm_movemask_epi8(alnum128(v)) & 0xFFFFu;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipAlnumScalar(p + i, n - i);
+}
+
+static size_t skipIdentifierTailSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i tail = _mm_or_si128(alnum128(v), _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+        unsigned mask = ~_mm_movemask_epi8(tail) & 0xFFFFu;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipIdentifierTailScalar(p + i, n - i);
+}
+
+static size_t skipDigitsSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = ~_mm_movemask_epi8(inRange128(v, '0', '9')) & 0xFFFFu;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipDigitsScalar(p + i, n - i);
+}
+
+static size_t skipStringBodySse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = _mm_movemask_epi8(stringEnd128(v));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipStringBodyScalar(p + i, n - i);
+}
+
+/*AVX2: 32 bytes per step, only called after CPUID reports support*/
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i whitespace256(__m256i v) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    return _mm256_or_si256(in_range, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+}
+
+AVX2_TARGET static size_t findSpecialAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(whitespace256(v), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findSpecialSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t skipWhitespaceAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(whitespace256(v)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipWhitespaceSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t findLineEndAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findLineEndSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t findBlockEndAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 33 <= n; i += 32) {
+        __m256i star = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i slash = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 1));
+        __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(star, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(slash, _mm256_set1_epi8('/')));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findBlockEndSse2(p + i, n - i);
+}
+
+/*
+ * character classes by nibble lookup: class(b) = LO[b & 15] & HI[b >> 4].
+ * letters are split in two bits so each class is a product of a low and a high nibble set:
+ * 0x41-0x4F/0x61-0x6F and 0x50-0x5A/0x70-0x7A. bytes >= 0x80 have no class.
+ */
+enum CHAR_CLASS_BIT : char {
+    CC_DIGIT = 0x01,
+    CC_ALPHA_LOW = 0x02,
+    CC_ALPHA_HIGH = 0x04,
+    CC_MINUS = 0x08,
+    CC_ALNUM = CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH
+};
+
+AVX2_TARGET static inline __m256i classify256(__m256i v) {
+    const __m256i lo_table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        CC_DIGIT | CC_ALPHA_HIGH,                  // 0
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 1
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 2
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 3
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 4
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 5
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 6
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 7
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 8
+        CC_DIGIT | CC_ALPHA_LOW | CC_ALPHA_HIGH,   // 9
+        CC_ALPHA_LOW | CC_ALPHA_HIGH,              // A
+        CC_ALPHA_LOW,                              // B
+        CC_ALPHA_LOW,                              // C
+        CC_ALPHA_LOW | CC_MINUS,                   // D
+        CC_ALPHA_LOW,                              // E
+        CC_ALPHA_LOW));                            // F
+    const __m256i hi_table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0, 0, CC_MINUS, CC_DIGIT, CC_ALPHA_LOW, CC_ALPHA_HIGH, CC_ALPHA_LOW, CC_ALPHA_HIGH,
+        0, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(hi_table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    return _mm256_and_si256(lo, hi);
+}
+
+// bit i set where byte i has none of the classes in `wanted`
+AVX2_TARGET static inline unsigned outsideClass256(__m256i v, char wanted) {
+    __m256i hit = _mm256_and_si256(classify256(v), _mm256_set1_epi8(wanted));
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+}
+
+AVX2_TARGET static size_t skipAlnumAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        unsigned mask = outsideClass256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), CC_ALNUM);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipAlnumSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t skipIdentifierTailAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        unsigned mask = outsideClass256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), CC_ALNUM | CC_MINUS);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipIdentifierTailSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t skipDigitsAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        unsigned mask = outsideClass256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), CC_DIGIT);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipDigitsSse2(p + i, n - i);
+}
+
+AVX2_TARGET static size_t skipStringBodyAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i control = _mm256_cmpgt_epi8(_mm256_set1_epi8(32), v);
+        __m256i allowed = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+                                          _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        __m256i end = _mm256_or_si256(_mm256_andnot_si256(allowed, control), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(end));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + skipStringBodySse2(p + i, n - i);
+}
+
+const SCAN_KERNELS* sse2Kernels() {
+    static const SCAN_KERNELS kernels{
+        "sse2", findSpecialSse2, skipWhitespaceSse2, findLineEndSse2, findBlockEndSse2,
+        skipAlnumSse2, skipIdentifierTailSse2, skipDigitsSse2, skipStringBodySse2
+    };
+    return &kernels;
+}
+
+const SCAN_KERNELS* avx2Kernels() {
+    static const SCAN_KERNELS kernels{
+        "avx2", findSpecialAvx2, skipWhitespaceAvx2, findLineEndAvx2, findBlockEndAvx2,
+        skipAlnumAvx2, skipIdentifierTailAvx2, skipDigitsAvx2, skipStringBodyAvx2
+    };
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &kernels : nullptr;
+}
+
+static const SCAN_KERNELS& pickKernels() {
+    return avx2Kernels() ? *avx2Kernels() : *sse2Kernels();
+}
+
+#else
+
+const SCAN_KERNELS* sse2Kernels() {
+    return nullptr;
+}
+
+const SCAN_KERNELS* avx2Kernels() {
+    return nullptr;
+}
+
+static const SCAN_KERNELS& pickKernels() {
+    return scalarKernels();
+}
+
+#endif
+
+const SCAN_KERNELS& scanKernels() {
+    static const SCAN_KERNELS& kernels = pickKernels();
+    return kernels;
+}
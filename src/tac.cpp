@@ -0,0 +1,351 @@
+#include "tac.hpp"
+#include <algorithm>
+
+namespace {
+
+struct OPERAND {
+    OPERAND_KIND kind;
+    uint32_t index;
+};
+
+constexpr OPERAND NONE{OPERAND_NONE, 0};
+
+TAC_OP binaryOp(TOKEN_KIND op) {
+    switch (op) {
+        case TK_PLUS: return TAC_ADD;
+        case TK_MINUS: return TAC_SUBTRACT;
+        case TK_STAR: return TAC_MULTIPLY;
+        case TK_SLASH: return TAC_DIVIDE;
+        case TK_EQ: return TAC_EQ;
+        case TK_LT: return TAC_LT;
+        case TK_GT: return TAC_GT;
+        case TK_LE: return TAC_LE;
+        case TK_GE: return TAC_GE;
+        default: return TAC_NE;     // != and <>
+    }
+}
+
+/*
+ * the walk is an explicit stack of (node, stage): a statement is visited once per child it
+ * has to place code around, and an expression leaves its result on the values stack.
+ */
+class TAC_GENERATOR {
+public:
+    TAC_GENERATOR(const AST& _tree, const TokenStream& _tokens, const NAME_BINDINGS& _names,
+                  TABLE<LITERAL_TABLE_ENTRY>& _literal_table)
+        : tree(_tree), tokens(_tokens), names(_names), literal_table(_literal_table) {}
+
+    TAC run() {
+        // most nodes become one quad, loops and conditionals a few more
+        tac.code.reserve(tree.size() + tree.size() / 2);
+        if (!tree.empty())
+            walk.push_back({tree.root(), 0, 0, 0});
+        while (!walk.empty()) {
+            TASK task = walk.back();
+            walk.pop_back();
+            visit(task);
+        }
+        return std::move(tac);
+    }
+
+private:
+    struct TASK {
+        uint32_t node;
+        uint32_t stage;
+        uint32_t label;     // loop top or else branch
+        uint32_t end;       // label after the statement
+    };
+
+    const AST& tree;
+    const TokenStream& tokens;
+    const NAME_BINDINGS& names;
+    TABLE<LITERAL_TABLE_ENTRY>& literal_table;
+    TAC tac;
+    std::vector<TASK> walk;
+    std::vector<OPERAND> values;
+    uint32_t next_temp = 0;
+    size_t function_quad = 0;   // TAC_FUNCTION of the function being translated
+
+    void emit(TAC_OP op, OPERAND result, OPERAND left = NONE, OPERAND right = NONE) {
+        tac.code.push_back({op, result.kind, left.kind, right.kind, result.index, left.index, right.index});
+    }
+
+    uint32_t newLabel() {
+        tac.labels.push_back(0);
+        return static_cast<uint32_t>(tac.labels.size() - 1);
+    }
+
+    void placeLabel(uint32_t label) {
+        tac.labels[label] = static_cast<uint32_t>(tac.code.size());
+        emit(TAC_LABEL, NONE, {OPERAND_LABEL, label});
+    }
+
+    OPERAND newTemp() {
+        QUAD& function = tac.code[function_quad];
+        function.right = std::max(function.right, next_temp + 1);
+        return {OPERAND_TEMP, next_temp++};
+    }
+
+    // the literal a local of type starts at; Matn locals have none
+    OPERAND zeroOf(DATA_TYPE type) {
+        switch (type) {
+            case T_ADADI: case T_HARF: return {OPERAND_LITERAL, insertValue(literal_table, LITERAL_TABLE_ENTRY(int64_t(0)))};
+            case T_ASHRIYA: return {OPERAND_LITERAL, insertValue(literal_table, LITERAL_TABLE_ENTRY(0.0))};
+            case T_MANTIQI: return {OPERAND_LITERAL, insertValue(literal_table, LITERAL_TABLE_ENTRY(false))};
+            default: return NONE;
+        }
+    }
+
+    OPERAND pop() {
+        OPERAND value = values.back();
+        values.pop_back();
+        return value;
+    }
+
+    void then(const TASK& task, uint32_t child) {
+        walk.push_back({task.node, task.stage + 1, task.label, task.end});
+        walk.push_back({child, 0, 0, 0});
+    }
+
+    void visit(const TASK& task) {
+        const AST_NODE& node = tree[task.node];
+        AST::CHILDREN children = tree.children(task.node);
+        switch (node.kind) {
+            case NODE_PROGRAMME:
+            case NODE_BLOCK:
+                for (uint32_t i = children.size(); i-- > 0;) {
+                    walk.push_back({children[i], 0, 0, 0});
+                }
+                break;
+            case NODE_FUNCTION:
+                if (task.stage == 0) {
+                    function_quad = tac.code.size();
+                    emit(TAC_FUNCTION, {OPERAND_SYMBOL, names.symbolOf(task.node)}, {OPERAND_NONE, children.size() - 1});
+                    walk.push_back({task.node, 1, 0, 0});
+                    for (uint32_t i = children.size(); i-- > 0;) {
+                        walk.push_back({children[i], 0, 0, 0});
+                    }
+                } else {
+                    emit(TAC_RETURN, NONE);
+                    emit(TAC_END, NONE);
+                }
+                break;
+            case NODE_PARAM:
+                emit(TAC_PARAM, {OPERAND_SYMBOL, names.symbolOf(task.node)});
+                break;
+            case NODE_DECLARATION:
+                // globals start at zero once, before anything runs
+                if (names.scopes[names.symbolOf(children[0])].depth == 0) break;
+                for (uint32_t name : children) {
+                    OPERAND zero = zeroOf(names.scopes[names.symbolOf(name)].type);
+                    if (zero.kind != OPERAND_NONE)
+                        emit(TAC_COPY, {OPERAND_SYMBOL, names.symbolOf(name)}, zero);
+                }
+                break;
+            case NODE_OUTPUT:
+                if (task.stage == 0) then(task, children[0]);
+                else emit(TAC_OUTPUT, NONE, pop());
+                break;
+            case NODE_INPUT:
+                emit(TAC_INPUT, {OPERAND_SYMBOL, names.symbolOf(children[0])});
+                break;
+            case NODE_EXPR_STMT:
+                if (task.stage == 0) then(task, children[0]);
+                else pop();
+                break;
+            case NODE_RETURN:
+                if (task.stage == 0) then(task, children[0]);
+                else emit(TAC_RETURN, NONE, pop());
+                break;
+            case NODE_IF:
+                // condition, then [, else]
+                if (task.stage == 0) {
+                    then(task, children[0]);
+                } else if (task.stage == 1) {
+                    uint32_t otherwise = newLabel();
+                    emit(TAC_JUMP_IF_FALSE, NONE, pop(), {OPERAND_LABEL, otherwise});
+                    walk.push_back({task.node, 2, otherwise, 0});
+                    walk.push_back({children[1], 0, 0, 0});
+                } else if (task.stage == 2 && children.size() == 3) {
+                    uint32_t end = newLabel();
+                    emit(TAC_JUMP, NONE, {OPERAND_LABEL, end});
+                    placeLabel(task.label);
+                    walk.push_back({task.node, 3, task.label, end});
+                    walk.push_back({children[2], 0, 0, 0});
+                } else {
+                    placeLabel(task.stage == 2 ? task.label : task.end);
+                }
+                break;
+            case NODE_WHILE:
+                // condition, body
+                if (task.stage == 0) {
+                    TASK loop{task.node, 0, newLabel(), newLabel()};
+                    placeLabel(loop.label);
+                    then(loop, children[0]);
+                } else if (task.stage == 1) {
+                    emit(TAC_JUMP_IF_FALSE, NONE, pop(), {OPERAND_LABEL, task.end});
+                    then(task, children[1]);
+                } else {
+                    emit(TAC_JUMP, NONE, {OPERAND_LABEL, task.label});
+                    placeLabel(task.end);
+                }
+                break;
+            case NODE_FOR:
+                // init, condition, step, body; a missing clause is a NODE_EMPTY, whose value is NONE
+                if (task.stage == 0) {
+                    then(task, children[0]);
+                } else if (task.stage == 1) {
+                    pop();
+                    TASK loop{task.node, 1, newLabel(), newLabel()};
+                    placeLabel(loop.label);
+                    then(loop, children[1]);
+                } else if (task.stage == 2) {
+                    OPERAND condition = pop();
+                    if (condition.kind != OPERAND_NONE)
+                        emit(TAC_JUMP_IF_FALSE, NONE, condition, {OPERAND_LABEL, task.end});
+                    then(task, children[3]);
+                } else if (task.stage == 3) {
+                    then(task, children[2]);
+                } else {
+                    pop();
+                    emit(TAC_JUMP, NONE, {OPERAND_LABEL, task.label});
+                    placeLabel(task.end);
+                }
+                break;
+            case NODE_EMPTY:
+                values.push_back(NONE);
+                break;
+            case NODE_IDENTIFIER:
+                values.push_back({OPERAND_SYMBOL, names.symbolOf(task.node)});
+                break;
+            case NODE_NUMBER:
+                values.push_back({OPERAND_LITERAL, static_cast<uint32_t>(tokens.id(node.token))});
+                break;
+            case NODE_STRING:
+                values.push_back({OPERAND_LITERAL, static_cast<uint32_t>(tokens.id(node.token))});
+                break;
+            case NODE_BOOLEAN:
+                values.push_back({OPERAND_LITERAL, insertValue(literal_table, LITERAL_TABLE_ENTRY(node.op == KW_TRUE))});
+                break;
+            case NODE_ASSIGN:
+                // target, value
+                if (task.stage == 0) {
+                    if (values.empty()) next_temp = 0;
+                    then(task, children[1]);
+                } else {
+                    OPERAND target{OPERAND_SYMBOL, names.symbolOf(children[0])};
+                    emit(TAC_COPY, target, pop());
+                    values.push_back(target);
+                }
+                break;
+            case NODE_CALL:
+                if (task.stage == 0) {
+                    if (values.empty()) next_temp = 0;
+                    walk.push_back({task.node, 1, 0, 0});
+                    for (uint32_t i = children.size(); i-- > 0;) {
+                        walk.push_back({children[i], 0, 0, 0});
+                    }
+                } else {
+                    // the arguments are the top children.size() values, first one deepest
+                    size_t first = values.size() - children.size();
+                    for (size_t i = first; i < values.size(); ++i) {
+                        emit(TAC_ARG, NONE, values[i]);
+                    }
+                    values.resize(first);
+                    OPERAND result = newTemp();
+                    emit(TAC_CALL, result, {OPERAND_SYMBOL, names.symbolOf(task.node)}, {OPERAND_NONE, children.size()});
+                    values.push_back(result);
+                }
+                break;
+            case NODE_BINARY:
+                if (task.stage == 0) {
+                    // nothing else is live when an expression starts, so its temporaries start over
+                    if (values.empty()) next_temp = 0;
+                    walk.push_back({task.node, 1, 0, 0});
+                    walk.push_back({children[1], 0, 0, 0});
+                    walk.push_back({children[0], 0, 0, 0});
+                } else {
+                    OPERAND right = pop();
+                    OPERAND left = pop();
+                    OPERAND result = newTemp();
+                    emit(binaryOp(node.op), result, left, right);
+                    values.push_back(result);
+                }
+                break;
+            default:
+                // parse errors never reach here
+                break;
+        }
+    }
+};
+
+}
+
+LITERAL_TABLE_ENTRY convertTo(DATA_TYPE type, const LITERAL_TABLE_ENTRY& value) {
+    switch (type) {
+        case T_ADADI:
+        case T_HARF: {
+            LITERAL_TABLE_ENTRY result(value.datatype == T_ASHRIYA ? truncateToAdadi(value.decimal) : value.integer);
+            result.datatype = type;
+            return result;
+        }
+        case T_ASHRIYA:
+            return LITERAL_TABLE_ENTRY(value.datatype == T_ASHRIYA ? value.decimal : static_cast<double>(value.integer));
+        case T_MANTIQI:
+            return LITERAL_TABLE_ENTRY(value.datatype == T_ASHRIYA ? value.decimal != 0 : value.integer != 0);
+        default:
+            return value;
+    }
+}
+
+TAC generateTAC(const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                TABLE<LITERAL_TABLE_ENTRY>& literal_table) {
+    return TAC_GENERATOR(tree, tokens, names, literal_table).run();
+}
+
+static const char* const TAC_OP_SPELLINGS[TAC_OP_COUNT] = {
+    "", "+", "-", "*", "/", "==", "!=", "<", ">", "<=", ">=",
+};
+
+static std::string operandToString(OPERAND_KIND kind, uint32_t index, const AST& tree, const TokenStream& tokens,
+                                   const NAME_BINDINGS& names, const TABLE<LITERAL_TABLE_ENTRY>& literals) {
+    switch (kind) {
+        case OPERAND_TEMP: return "t" + std::to_string(index);
+        case OPERAND_SYMBOL: return std::string(tokens.lexeme(tree[names.scopes[index].node].token));
+        case OPERAND_LITERAL: {
+            std::string value = literals[index].toString(literals.lexeme(index));
+            return value.substr(0, value.rfind(", "));
+        }
+        case OPERAND_LABEL: return "L" + std::to_string(index);
+        default: return "";
+    }
+}
+
+std::string tacToString(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                        const TABLE<LITERAL_TABLE_ENTRY>& literals) {
+    std::string text;
+    for (const QUAD& quad : tac.code) {
+        std::string result = operandToString(quad.result_kind, quad.result, tree, tokens, names, literals);
+        std::string left = operandToString(quad.left_kind, quad.left, tree, tokens, names, literals);
+        std::string right = operandToString(quad.right_kind, quad.right, tree, tokens, names, literals);
+        switch (quad.op) {
+            case TAC_COPY: text += "    " + result + " := " + left; break;
+            case TAC_LABEL: text += left + ":"; break;
+            case TAC_JUMP: text += "    goto " + left; break;
+            case TAC_JUMP_IF_FALSE: text += "    ifFalse " + left + " goto " + right; break;
+            case TAC_FUNCTION:
+                text += "function " + result + ", " + std::to_string(quad.left) + " params, " + std::to_string(quad.right) + " temps";
+                break;
+            case TAC_PARAM: text += "    param " + result; break;
+            case TAC_ARG: text += "    arg " + left; break;
+            case TAC_CALL: text += "    " + result + " := call " + left + ", " + std::to_string(quad.right); break;
+            case TAC_OUTPUT: text += "    output " + left; break;
+            case TAC_INPUT: text += "    input " + result; break;
+            case TAC_RETURN: text += left.empty() ? "    return" : "    return " + left; break;
+            case TAC_END: text += "end"; break;
+            default: text += "    " + result + " := " + left + " " + TAC_OP_SPELLINGS[quad.op] + " " + right; break;
+        }
+        text += "\n";
+    }
+    return text;
+}
@@ -0,0 +1,81 @@
+#include "tree_sink.hpp"
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+SINK_FILE::SINK_FILE(const char* filename) {
+    fd = ::open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1) {
+        std::cerr << "SINK_FILE:SINK_FILE() unable to open " << filename << "\n";
+    }
+    buffer.reserve(FLUSH_SIZE + 4096);
+}
+
+SINK_FILE::~SINK_FILE() {
+    flush();
+    if (fd != -1) ::close(fd);
+}
+
+void SINK_FILE::flush() {
+    size_t written = 0;
+    while (fd != -1 && written < buffer.size()) {
+        ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            // a tree with a piece missing is worse than none, so nothing more is written
+            std::cerr << "SINK_FILE:flush() write failed\n";
+            ::close(fd);
+            fd = -1;
+            break;
+        }
+        written += n;
+    }
+    buffer.clear();
+}
+
+void TEXT_SINK::line(const char* name) {
+    buffer.append(depth, '\t');
+    if (*name != '\0') {
+        buffer += name;
+        buffer += '\n';
+        buffer.append(depth, '\t');
+        buffer += "|\n";
+    } else {
+        buffer += '\n';
+    }
+    flushIfFull();
+}
+
+void TEXT_SINK::open(GRAMMAR_SYMBOL symbol) {
+    ++depth;
+    next_line = true;
+    line(GRAMMAR_SYMBOL_NAMES[symbol]);
+}
+
+void TEXT_SINK::leaf(GRAMMAR_SYMBOL symbol) {
+    // leaves are labelled with their token class, as the lexer prints it
+    ++depth;
+    line(symbol == TS_IDENTIFIER ? "Identifier" : symbol == TS_NUMBER ? "Number" : GRAMMAR_SYMBOL_NAMES[symbol]);
+    line("");
+    next_line = false;
+    --depth;
+}
+
+void TEXT_SINK::close(uint32_t count) {
+    while (count-- > 0) {
+        if (next_line) line("");
+        next_line = false;
+        --depth;
+    }
+}
+
+BINARY_SINK::BINARY_SINK(const char* filename) : SINK_FILE(filename) {
+    buffer += "UPT1";
+    buffer += static_cast<char>(GRAMMAR_SYMBOL_COUNT);
+    for (int symbol = 0; symbol < GRAMMAR_SYMBOL_COUNT; ++symbol) {
+        buffer += GRAMMAR_SYMBOL_NAMES[symbol];
+        buffer += '\0';
+    }
+}
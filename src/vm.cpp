@@ -0,0 +1,733 @@
+#include "vm.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <unistd.h>
+
+uint32_t BYTECODE::findFunction(std::string_view name) const {
+    for (uint32_t i = 0; i < functions.size(); ++i) {
+        if (functions[i].name == name)
+            return i;
+    }
+    return NO_FUNCTION;
+}
+
+namespace {
+
+constexpr uint32_t UNASSIGNED = UINT32_MAX;
+constexpr uint32_t MAX_REGISTER = (1u << 24) - 1;
+constexpr uint32_t SCRATCH_REGISTERS = 3;
+
+bool isDecimal(DATA_TYPE type) { return type == T_ASHRIYA; }
+
+// the one instruction that turns a value of type from into one of type to
+OPCODE conversion(DATA_TYPE from, DATA_TYPE to) {
+    if (to == T_MANTIQI && from != T_MANTIQI)
+        return isDecimal(from) ? OP_FLOAT_TO_BOOL : OP_INT_TO_BOOL;
+    if (isDecimal(to) != isDecimal(from))
+        return isDecimal(to) ? OP_INT_TO_FLOAT : OP_FLOAT_TO_INT;
+    return OP_MOVE;
+}
+
+bool isComputation(uint32_t op) { return op >= OP_ADD_I && op <= OP_GE_F; }
+bool isComparison(uint32_t op) { return op >= OP_EQ_I && op <= OP_GE_F; }
+
+// the string a Matn literal's lexeme spells, without its quotes and with \n, \t and \\ expanded
+std::string unquote(std::string_view lexeme) {
+    std::string text;
+    lexeme = lexeme.substr(1, lexeme.size() >= 2 ? lexeme.size() - 2 : 0);
+    for (size_t i = 0; i < lexeme.size(); ++i) {
+        if (lexeme[i] == '\\' && i + 1 < lexeme.size()) {
+            char next = lexeme[i + 1];
+            if (next == 'n' || next == 't' || next == '\\') {
+                text += next == 'n' ? '\n' : next == 't' ? '\t' : '\\';
+                ++i;
+                continue;
+            }
+        }
+        text += lexeme[i];
+    }
+    return text;
+}
+
+/*
+ * one pass over the TAC of each function. locals get registers before the function's code
+ * is compiled, so temporaries, scratch and constant registers sit at fixed places after
+ * them; jump targets and the registers just past the frame are patched in at the end.
+ * two quads often become one instruction: a computation whose temporary is copied straight
+ * into a variable writes the variable instead, and a comparison that an ifFalse tests is
+ * fused with it.
+ */
+class BYTECODE_COMPILER {
+public:
+    BYTECODE_COMPILER(const TAC& _tac, const AST& _tree, const TokenStream& _tokens, const NAME_BINDINGS& _names,
+                      const TABLE<LITERAL_TABLE_ENTRY>& _literals, BYTECODE& _out, std::vector<std::string>& _errors)
+        : tac(_tac), tree(_tree), tokens(_tokens), names(_names), literals(_literals), out(_out), errors(_errors) {}
+
+    bool run() {
+        size_t symbols = names.scopes.symbols().size();
+        function_of.assign(symbols, UNASSIGNED);
+        global_of.assign(symbols, UNASSIGNED);
+        register_of.assign(symbols, UNASSIGNED);
+        reported.assign(symbols, false);
+        label_at.assign(tac.labels.size(), UNASSIGNED);
+        declareFunctions();
+        for (uint32_t symbol = 0; symbol < symbols; ++symbol) {
+            const SYMBOL& s = names.scopes[symbol];
+            if (s.depth == 0 && function_of[symbol] == UNASSIGNED)
+                global_of[symbol] = out.globals++;
+        }
+        out.code.reserve(tac.code.size());
+        for (size_t i = 0; i < tac.code.size(); ++i) {
+            if (tac.code[i].op == TAC_FUNCTION)
+                i = compileFunction(i);
+        }
+        return errors.empty();
+    }
+
+private:
+    const TAC& tac;
+    const AST& tree;
+    const TokenStream& tokens;
+    const NAME_BINDINGS& names;
+    const TABLE<LITERAL_TABLE_ENTRY>& literals;
+    BYTECODE& out;
+    std::vector<std::string>& errors;
+
+    std::vector<uint32_t> function_of;      // symbol -> index in out.functions
+    std::vector<uint32_t> global_of;        // symbol -> global
+    std::vector<uint32_t> register_of;      // symbol -> register in the function being compiled
+    std::vector<bool> reported;             // symbols already in errors
+    std::vector<uint32_t> label_at;         // label -> instruction
+    std::vector<DATA_TYPE> param_types;     // every function's, one after another
+    std::vector<uint32_t> params_at;        // function -> its first entry in param_types
+    std::unordered_map<uint32_t, uint32_t> string_of;   // literal -> index in out.strings
+
+    // the function being compiled
+    uint32_t current = 0;
+    uint32_t temps_at = 0;
+    uint32_t scratch_at = 0;
+    std::vector<DATA_TYPE> temp_types;
+    std::unordered_map<uint64_t, uint32_t> integer_constants, decimal_constants;
+    std::vector<uint32_t> locals;           // symbols given a register, cleared after the function
+    std::vector<QUAD> arguments;            // TAC_ARG operands waiting for their TAC_CALL, in left
+    std::vector<uint32_t> jumps;            // instructions whose target still holds a label
+    std::vector<uint32_t> past_frame;       // instructions with a register counted from the frame's end
+    uint32_t largest_call = 0;
+
+    std::string_view nameOf(uint32_t symbol) const {
+        return tokens.lexeme(tree[names.scopes[symbol].node].token);
+    }
+
+    void error(const std::string& message) {
+        errors.push_back(message + " in '" + out.functions[current].name + "'");
+    }
+
+    void declareFunctions() {
+        for (size_t i = 0; i < tac.code.size(); ++i) {
+            const QUAD& quad = tac.code[i];
+            if (quad.op != TAC_FUNCTION)
+                continue;
+            function_of[quad.result] = static_cast<uint32_t>(out.functions.size());
+            params_at.push_back(static_cast<uint32_t>(param_types.size()));
+            BYTECODE_FUNCTION function;
+            function.name = std::string(nameOf(quad.result));
+            function.type = names.scopes[quad.result].type;
+            function.params = quad.left;
+            for (uint32_t p = 0; p < quad.left; ++p) {
+                param_types.push_back(names.scopes[tac.code[i + 1 + p].result].type);
+            }
+            out.functions.push_back(std::move(function));
+        }
+    }
+
+    void emit(OPCODE op, uint32_t a, uint32_t b = 0, uint32_t c = 0) {
+        out.code.push_back({op, a, b, c});
+    }
+
+    // symbols are values unless they name a function or are Matn
+    bool checkValue(uint32_t symbol) {
+        if (function_of[symbol] == UNASSIGNED && names.scopes[symbol].type != T_MATN)
+            return true;
+        if (!reported[symbol]) {
+            reported[symbol] = true;
+            if (function_of[symbol] != UNASSIGNED)
+                error("'" + std::string(nameOf(symbol)) + "' is a function, not a value");
+            else
+                error("'" + std::string(nameOf(symbol)) + "' is Matn, which the interpreter does not run");
+        }
+        return false;
+    }
+
+    DATA_TYPE typeOf(OPERAND_KIND kind, uint32_t index) const {
+        switch (kind) {
+            case OPERAND_TEMP: return temp_types[index];
+            case OPERAND_SYMBOL: return names.scopes[index].type;
+            case OPERAND_LITERAL: return literals[index].datatype;
+            default: return T_DEFAULT;
+        }
+    }
+
+    uint32_t constant(const LITERAL_TABLE_ENTRY& value) {
+        BYTECODE_FUNCTION& function = out.functions[current];
+        SLOT slot;
+        if (isDecimal(value.datatype)) slot.f = value.decimal;
+        else slot.i = value.integer;
+        uint64_t bits;
+        std::memcpy(&bits, &slot, sizeof(bits));
+        auto& constants = isDecimal(value.datatype) ? decimal_constants : integer_constants;
+        auto found = constants.emplace(bits, static_cast<uint32_t>(function.constants.size()));
+        if (found.second)
+            function.constants.push_back(slot);
+        return function.constants_at + found.first->second;
+    }
+
+    uint32_t scratch(uint32_t n) const { return scratch_at + n; }
+
+    /*
+     * the register holding an operand, converted to type unless that is T_DEFAULT. globals
+     * and conversions go through scratch register n.
+     */
+    uint32_t read(OPERAND_KIND kind, uint32_t index, DATA_TYPE type, uint32_t n) {
+        if (kind == OPERAND_LITERAL) {
+            if (literals[index].datatype == T_MATN) {
+                error("strings can only be written by output<-");
+                return constant(LITERAL_TABLE_ENTRY(int64_t(0)));
+            }
+            return constant(type == T_DEFAULT ? literals[index] : convertTo(type, literals[index]));
+        }
+        uint32_t reg = temps_at + index;
+        if (kind == OPERAND_SYMBOL) {
+            if (!checkValue(index))
+                return scratch(n);
+            if (global_of[index] != UNASSIGNED) {
+                emit(OP_GET_GLOBAL, scratch(n), global_of[index]);
+                reg = scratch(n);
+            } else {
+                reg = register_of[index];
+            }
+        }
+        OPCODE op = type == T_DEFAULT ? OP_MOVE : conversion(typeOf(kind, index), type);
+        if (op == OP_MOVE)
+            return reg;
+        emit(op, scratch(n), reg);
+        return scratch(n);
+    }
+
+    // the register a value of type can be computed straight into for the result operand, or UNASSIGNED
+    uint32_t destination(const QUAD& quad, DATA_TYPE type) {
+        if (quad.result_kind == OPERAND_TEMP) {
+            temp_types[quad.result] = type;
+            return temps_at + quad.result;
+        }
+        if (checkValue(quad.result) && global_of[quad.result] == UNASSIGNED &&
+            conversion(type, names.scopes[quad.result].type) == OP_MOVE)
+            return register_of[quad.result];
+        return UNASSIGNED;
+    }
+
+    // puts a value of type, in reg, into the result operand
+    void store(const QUAD& quad, uint32_t reg, DATA_TYPE type) {
+        if (quad.result_kind == OPERAND_TEMP) {
+            temp_types[quad.result] = type;
+            if (reg != temps_at + quad.result)
+                emit(OP_MOVE, temps_at + quad.result, reg);
+            return;
+        }
+        if (!checkValue(quad.result))
+            return;
+        OPCODE op = conversion(type, names.scopes[quad.result].type);
+        if (global_of[quad.result] != UNASSIGNED) {
+            if (op != OP_MOVE) {
+                emit(op, scratch(2), reg);
+                reg = scratch(2);
+            }
+            emit(OP_SET_GLOBAL, global_of[quad.result], reg);
+        } else if (op != OP_MOVE || reg != register_of[quad.result]) {
+            emit(op, register_of[quad.result], reg);
+        }
+    }
+
+    // true if the last instruction wrote temporary temp, computed by quad i - 1
+    bool justComputed(size_t i, uint32_t temp) const {
+        const QUAD& previous = tac.code[i - 1];
+        return previous.result_kind == OPERAND_TEMP && previous.result == temp && !out.code.empty() &&
+               out.code.back().a == temps_at + temp &&
+               (isComputation(out.code.back().op) || out.code.back().op == OP_CALL);
+    }
+
+    void giveRegister(OPERAND_KIND kind, uint32_t symbol, uint32_t& next) {
+        if (kind == OPERAND_SYMBOL && names.scopes[symbol].depth > 0 && register_of[symbol] == UNASSIGNED) {
+            register_of[symbol] = next++;
+            locals.push_back(symbol);
+        }
+    }
+
+    size_t compileFunction(size_t start) {
+        const QUAD& header = tac.code[start];
+        current = function_of[header.result];
+        BYTECODE_FUNCTION& function = out.functions[current];
+        function.entry = static_cast<uint32_t>(out.code.size());
+        if (function.type == T_MATN)
+            error("returning Matn is not supported by the interpreter");
+
+        // parameters first, in order, since the caller puts the arguments there
+        size_t end = start + 1;
+        uint32_t next = 0;
+        for (; tac.code[end].op != TAC_END; ++end) {
+            const QUAD& quad = tac.code[end];
+            giveRegister(quad.result_kind, quad.result, next);
+            giveRegister(quad.left_kind, quad.left, next);
+            giveRegister(quad.right_kind, quad.right, next);
+        }
+        temps_at = next;
+        scratch_at = temps_at + header.right;
+        function.constants_at = scratch_at + SCRATCH_REGISTERS;
+        temp_types.assign(header.right, T_ADADI);
+        integer_constants.clear();
+        decimal_constants.clear();
+        jumps.clear();
+        past_frame.clear();
+        arguments.clear();
+        largest_call = 0;
+
+        for (size_t i = start + 1; i < end; ++i) {
+            compile(i);
+        }
+
+        function.frame_size = function.constants_at + static_cast<uint32_t>(function.constants.size());
+        function.stack_size = function.frame_size + largest_call;
+        if (function.stack_size > MAX_REGISTER)
+            error("too many registers");
+        for (uint32_t at : jumps) {
+            INSTRUCTION& instruction = out.code[at];
+            if (instruction.op == OP_JUMP || instruction.op == OP_JUMP_IF_FALSE) instruction.b = label_at[instruction.b];
+            else instruction.c = label_at[instruction.c];
+        }
+        for (uint32_t at : past_frame) {
+            INSTRUCTION& instruction = out.code[at];
+            if (instruction.op == OP_CALL) instruction.c += function.frame_size;
+            else instruction.a = instruction.a + function.frame_size;
+        }
+        for (uint32_t symbol : locals) {
+            register_of[symbol] = UNASSIGNED;
+        }
+        locals.clear();
+        return end;
+    }
+
+    void compile(size_t i) {
+        const QUAD& quad = tac.code[i];
+        switch (quad.op) {
+            case TAC_COPY: {
+                DATA_TYPE type = typeOf(quad.left_kind, quad.left);
+                uint32_t direct = quad.result_kind == OPERAND_SYMBOL && quad.left_kind == OPERAND_TEMP &&
+                                  justComputed(i, quad.left) ? destination(quad, type) : UNASSIGNED;
+                if (direct != UNASSIGNED) {
+                    out.code.back().a = direct;
+                    break;
+                }
+                store(quad, read(quad.left_kind, quad.left, T_DEFAULT, 0), type);
+                break;
+            }
+            case TAC_ADD:
+            case TAC_SUBTRACT:
+            case TAC_MULTIPLY:
+            case TAC_DIVIDE:
+            case TAC_EQ:
+            case TAC_NE:
+            case TAC_LT:
+            case TAC_GT:
+            case TAC_LE:
+            case TAC_GE: {
+                bool decimal = isDecimal(typeOf(quad.left_kind, quad.left)) || isDecimal(typeOf(quad.right_kind, quad.right));
+                DATA_TYPE operands = decimal ? T_ASHRIYA : T_ADADI;
+                uint32_t left = read(quad.left_kind, quad.left, operands, 0);
+                uint32_t right = read(quad.right_kind, quad.right, operands, 1);
+                bool comparison = quad.op >= TAC_EQ;
+                OPCODE op = comparison ? OPCODE(OP_EQ_I + (quad.op - TAC_EQ) + (decimal ? OP_EQ_F - OP_EQ_I : 0))
+                                       : OPCODE(OP_ADD_I + (quad.op - TAC_ADD) + (decimal ? OP_ADD_F - OP_ADD_I : 0));
+                DATA_TYPE type = comparison ? T_MANTIQI : operands;
+                uint32_t direct = destination(quad, type);
+                emit(op, direct != UNASSIGNED ? direct : scratch(2), left, right);
+                if (direct == UNASSIGNED)
+                    store(quad, scratch(2), type);
+                break;
+            }
+            case TAC_LABEL:
+                label_at[quad.left] = static_cast<uint32_t>(out.code.size());
+                break;
+            case TAC_JUMP:
+                jumps.push_back(static_cast<uint32_t>(out.code.size()));
+                emit(OP_JUMP, 0, quad.left);
+                break;
+            case TAC_JUMP_IF_FALSE: {
+                jumps.push_back(static_cast<uint32_t>(out.code.size()));
+                if (quad.left_kind == OPERAND_TEMP && justComputed(i, quad.left) && isComparison(out.code.back().op)) {
+                    jumps.pop_back();
+                    jumps.push_back(static_cast<uint32_t>(out.code.size() - 1));
+                    INSTRUCTION& compare = out.code.back();
+                    compare = {static_cast<uint8_t>(OP_JUMP_UNLESS_EQ_I + (compare.op - OP_EQ_I)), compare.b, compare.c, quad.right};
+                    break;
+                }
+                uint32_t condition = read(quad.left_kind, quad.left, T_DEFAULT, 0);
+                if (isDecimal(typeOf(quad.left_kind, quad.left))) {
+                    emit(OP_FLOAT_TO_BOOL, scratch(0), condition);
+                    condition = scratch(0);
+                }
+                jumps.back() = static_cast<uint32_t>(out.code.size());
+                emit(OP_JUMP_IF_FALSE, condition, quad.right);
+                break;
+            }
+            case TAC_ARG:
+                arguments.push_back(quad);
+                break;
+            case TAC_CALL: {
+                uint32_t count = quad.right;
+                std::vector<QUAD> passed(arguments.end() - count, arguments.end());
+                arguments.resize(arguments.size() - count);
+                uint32_t callee = function_of[quad.left];
+                if (callee == UNASSIGNED) {
+                    error("'" + std::string(nameOf(quad.left)) + "' is called but is not a function");
+                    break;
+                }
+                if (count != out.functions[callee].params) {
+                    error("'" + out.functions[callee].name + "' takes " + std::to_string(out.functions[callee].params) +
+                          " arguments, not " + std::to_string(count));
+                    break;
+                }
+                for (uint32_t a = 0; a < count; ++a) {
+                    const QUAD& argument = passed[a];
+                    uint32_t reg = read(argument.left_kind, argument.left, T_DEFAULT, 0);
+                    past_frame.push_back(static_cast<uint32_t>(out.code.size()));
+                    emit(conversion(typeOf(argument.left_kind, argument.left), param_types[params_at[callee] + a]), a, reg);
+                }
+                largest_call = std::max(largest_call, count);
+                uint32_t direct = destination(quad, out.functions[callee].type);
+                past_frame.push_back(static_cast<uint32_t>(out.code.size()));
+                emit(OP_CALL, direct != UNASSIGNED ? direct : scratch(2), callee, 0);
+                if (direct == UNASSIGNED)
+                    store(quad, scratch(2), out.functions[callee].type);
+                break;
+            }
+            case TAC_OUTPUT: {
+                DATA_TYPE type = typeOf(quad.left_kind, quad.left);
+                if (quad.left_kind == OPERAND_LITERAL && type == T_MATN) {
+                    auto found = string_of.emplace(quad.left, static_cast<uint32_t>(out.strings.size()));
+                    if (found.second)
+                        out.strings.push_back(unquote(literals.lexeme(quad.left)));
+                    emit(OP_OUTPUT_S, found.first->second);
+                    break;
+                }
+                uint32_t reg = read(quad.left_kind, quad.left, T_DEFAULT, 0);
+                emit(type == T_ASHRIYA ? OP_OUTPUT_F : type == T_MANTIQI ? OP_OUTPUT_B : type == T_HARF ? OP_OUTPUT_C : OP_OUTPUT_I, reg);
+                break;
+            }
+            case TAC_INPUT: {
+                if (!checkValue(quad.result))
+                    break;
+                DATA_TYPE type = names.scopes[quad.result].type;
+                OPCODE op = type == T_ASHRIYA ? OP_INPUT_F : type == T_MANTIQI ? OP_INPUT_B : type == T_HARF ? OP_INPUT_C : OP_INPUT_I;
+                if (global_of[quad.result] != UNASSIGNED) {
+                    emit(op, scratch(0));
+                    emit(OP_SET_GLOBAL, global_of[quad.result], scratch(0));
+                } else {
+                    emit(op, register_of[quad.result]);
+                }
+                break;
+            }
+            case TAC_RETURN: {
+                DATA_TYPE type = out.functions[current].type;
+                if (quad.left_kind == OPERAND_NONE) {
+                    emit(OP_RETURN, constant(LITERAL_TABLE_ENTRY(int64_t(0))));
+                    break;
+                }
+                uint32_t reg = read(quad.left_kind, quad.left, T_DEFAULT, 0);
+                OPCODE op = conversion(typeOf(quad.left_kind, quad.left), type);
+                if (op != OP_MOVE) {
+                    emit(op, scratch(2), reg);
+                    reg = scratch(2);
+                }
+                emit(OP_RETURN, reg);
+                break;
+            }
+            default:
+                break;      // TAC_PARAM: the arguments are already in place
+        }
+    }
+};
+
+void writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(1, data, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+        data += written;
+        size -= written;
+    }
+}
+
+class OUTPUT_BUFFER {
+public:
+    ~OUTPUT_BUFFER() { flush(); }
+
+    void write(const char* text, size_t length) {
+        if (length > sizeof(data) - size) {
+            flush();
+            if (length > sizeof(data)) {
+                writeAll(text, length);
+                return;
+            }
+        }
+        std::memcpy(data + size, text, length);
+        size += length;
+    }
+
+    void flush() {
+        writeAll(data, size);
+        size = 0;
+    }
+
+private:
+    char data[1 << 16];
+    size_t size = 0;
+};
+
+/*whitespace separated words from file descriptor 0*/
+class INPUT_BUFFER {
+public:
+    explicit INPUT_BUFFER(OUTPUT_BUFFER& _output) : output(_output) {}
+
+    // the next word, empty at the end of the input
+    const std::string& word() {
+        text.clear();
+        while (peek() && isspace(static_cast<unsigned char>(data[at]))) ++at;
+        while (peek() && !isspace(static_cast<unsigned char>(data[at]))) text += data[at++];
+        return text;
+    }
+
+    // the next byte that is not whitespace, or -1 at the end of the input
+    int character() {
+        while (peek() && isspace(static_cast<unsigned char>(data[at]))) ++at;
+        return peek() ? static_cast<unsigned char>(data[at++]) : -1;
+    }
+
+private:
+    OUTPUT_BUFFER& output;
+    char data[1 << 16];
+    size_t at = 0, size = 0;
+    std::string text;
+
+    // true if there is a byte at data[at], reading more if needed; whatever was written is shown first
+    bool peek() {
+        if (at < size)
+            return true;
+        output.flush();
+        ssize_t got;
+        do got = ::read(0, data, sizeof(data));
+        while (got < 0 && errno == EINTR);
+        at = 0;
+        size = got > 0 ? static_cast<size_t>(got) : 0;
+        return size > 0;
+    }
+};
+
+constexpr size_t STACK_SLOTS = size_t(1) << 22;
+
+struct FRAME {
+    const INSTRUCTION* resume;      // the OP_CALL to return to
+    SLOT* base;
+    uint32_t function;
+};
+
+}
+
+int runBytecode(const BYTECODE& bytecode, uint32_t entry) {
+    // every handler, in OPCODE order
+    static const void* const DISPATCH[] = {
+        &&move, &&int_to_float, &&float_to_int, &&int_to_bool, &&float_to_bool,
+        &&add_i, &&subtract_i, &&multiply_i, &&divide_i,
+        &&add_f, &&subtract_f, &&multiply_f, &&divide_f,
+        &&eq_i, &&ne_i, &&lt_i, &&gt_i, &&le_i, &&ge_i,
+        &&eq_f, &&ne_f, &&lt_f, &&gt_f, &&le_f, &&ge_f,
+        &&jump_unless_eq_i, &&jump_unless_ne_i, &&jump_unless_lt_i, &&jump_unless_gt_i, &&jump_unless_le_i, &&jump_unless_ge_i,
+        &&jump_unless_eq_f, &&jump_unless_ne_f, &&jump_unless_lt_f, &&jump_unless_gt_f, &&jump_unless_le_f, &&jump_unless_ge_f,
+        &&jump, &&jump_if_false, &&get_global, &&set_global, &&call, &&return_,
+        &&output_i, &&output_f, &&output_b, &&output_c, &&output_s,
+        &&input_i, &&input_f, &&input_b, &&input_c,
+    };
+    static_assert(sizeof(DISPATCH) / sizeof(DISPATCH[0]) == OPCODE_COUNT, "one handler per opcode");
+
+    OUTPUT_BUFFER output;
+    INPUT_BUFFER input(output);
+    std::unique_ptr<SLOT[]> stack(new SLOT[STACK_SLOTS]);
+    std::vector<SLOT> globals(bytecode.globals, SLOT{0});
+    std::vector<FRAME> frames;
+    const char* failure = nullptr;
+    uint32_t function = entry;
+    char digits[32];
+    SLOT result;
+
+    const BYTECODE_FUNCTION& first = bytecode.functions[entry];
+    SLOT* base = stack.get();
+    SLOT* const stack_end = base + STACK_SLOTS;
+    if (first.stack_size > STACK_SLOTS) {
+        std::cerr << "[RUN ERROR] stack overflow in '" << first.name << "'\n";
+        return EXIT_FAILURE;
+    }
+    std::copy(first.constants.begin(), first.constants.end(), base + first.constants_at);
+    const INSTRUCTION* pc = bytecode.code.data() + first.entry;
+
+#define A base[pc->a]
+#define B base[pc->b]
+#define C base[pc->c]
+#define NEXT() goto *DISPATCH[(++pc)->op]
+#define JUMP_TO(target) do { pc = bytecode.code.data() + (target); goto *DISPATCH[pc->op]; } while (0)
+#define FAIL(message) do { failure = message; goto fail; } while (0)
+
+    goto *DISPATCH[pc->op];
+
+move: A = B; NEXT();
+int_to_float: A.f = static_cast<double>(B.i); NEXT();
+float_to_int: A.i = truncateToAdadi(B.f); NEXT();
+int_to_bool: A.i = B.i != 0; NEXT();
+float_to_bool: A.i = B.f != 0; NEXT();
+
+    // integer arithmetic wraps, so it goes through uint64_t
+add_i: A.i = static_cast<int64_t>(static_cast<uint64_t>(B.i) + static_cast<uint64_t>(C.i)); NEXT();
+subtract_i: A.i = static_cast<int64_t>(static_cast<uint64_t>(B.i) - static_cast<uint64_t>(C.i)); NEXT();
+multiply_i: A.i = static_cast<int64_t>(static_cast<uint64_t>(B.i) * static_cast<uint64_t>(C.i)); NEXT();
+divide_i:
+    if (C.i == 0) FAIL("division by zero");
+    A.i = C.i == -1 ? static_cast<int64_t>(0 - static_cast<uint64_t>(B.i)) : B.i / C.i;
+    NEXT();
+add_f: A.f = B.f + C.f; NEXT();
+subtract_f: A.f = B.f - C.f; NEXT();
+multiply_f: A.f = B.f * C.f; NEXT();
+divide_f: A.f = B.f / C.f; NEXT();
+
+eq_i: A.i = B.i == C.i; NEXT();
+ne_i: A.i = B.i != C.i; NEXT();
+lt_i: A.i = B.i < C.i; NEXT();
+gt_i: A.i = B.i > C.i; NEXT();
+le_i: A.i = B.i <= C.i; NEXT();
+ge_i: A.i = B.i >= C.i; NEXT();
+eq_f: A.i = B.f == C.f; NEXT();
+ne_f: A.i = B.f != C.f; NEXT();
+lt_f: A.i = B.f < C.f; NEXT();
+gt_f: A.i = B.f > C.f; NEXT();
+le_f: A.i = B.f <= C.f; NEXT();
+ge_f: A.i = B.f >= C.f; NEXT();
+
+jump_unless_eq_i: if (!(A.i == B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_ne_i: if (!(A.i != B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_lt_i: if (!(A.i < B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_gt_i: if (!(A.i > B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_le_i: if (!(A.i <= B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_ge_i: if (!(A.i >= B.i)) JUMP_TO(pc->c); NEXT();
+jump_unless_eq_f: if (!(A.f == B.f)) JUMP_TO(pc->c); NEXT();
+jump_unless_ne_f: if (!(A.f != B.f)) JUMP_TO(pc->c); NEXT();
+jump_unless_lt_f: if (!(A.f < B.f)) JUMP_TO(pc->c); NEXT();
+jump_unless_gt_f: if (!(A.f > B.f)) JUMP_TO(pc->c); NEXT();
+jump_unless_le_f: if (!(A.f <= B.f)) JUMP_TO(pc->c); NEXT();
+jump_unless_ge_f: if (!(A.f >= B.f)) JUMP_TO(pc->c); NEXT();
+
+jump: JUMP_TO(pc->b);
+jump_if_false: if (A.i == 0) JUMP_TO(pc->b); NEXT();
+
+get_global: A = globals[pc->b]; NEXT();
+set_global: globals[pc->a] = B; NEXT();
+
+call: {
+    const BYTECODE_FUNCTION& callee = bytecode.functions[pc->b];
+    SLOT* frame = base + pc->c;
+    if (callee.stack_size > static_cast<size_t>(stack_end - frame)) FAIL("stack overflow");
+    frames.push_back({pc, base, function});
+    std::copy(callee.constants.begin(), callee.constants.end(), frame + callee.constants_at);
+    base = frame;
+    function = pc->b;
+    JUMP_TO(callee.entry);
+}
+return_:
+    result = A;
+    if (frames.empty()) goto done;
+    pc = frames.back().resume;
+    base = frames.back().base;
+    function = frames.back().function;
+    frames.pop_back();
+    A = result;
+    NEXT();
+
+output_i: output.write(digits, std::to_chars(digits, digits + sizeof(digits), A.i).ptr - digits); NEXT();
+output_f: {
+    // shortest form that reads back the same, with a point so it does not look like an Adadi
+    char* end = std::to_chars(digits, digits + sizeof(digits), A.f).ptr;
+    if (std::all_of(digits, end, [](char c) { return c == '-' || (c >= '0' && c <= '9'); })) {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    output.write(digits, end - digits);
+    NEXT();
+}
+output_b: A.i ? output.write("True", 4) : output.write("False", 5); NEXT();
+output_c: digits[0] = static_cast<char>(A.i); output.write(digits, 1); NEXT();
+output_s: output.write(bytecode.strings[pc->a].data(), bytecode.strings[pc->a].size()); NEXT();
+
+input_i: {
+    const std::string& word = input.word();
+    if (word.empty()) FAIL("input ended");
+    const char* end = word.data() + word.size();
+    if (std::from_chars(word.data() + (word[0] == '+'), end, A.i).ptr != end) FAIL("expected an Adadi as input");
+    NEXT();
+}
+input_f: {
+    const std::string& word = input.word();
+    if (word.empty()) FAIL("input ended");
+    const char* end = word.data() + word.size();
+    if (std::from_chars(word.data() + (word[0] == '+'), end, A.f).ptr != end) FAIL("expected an Ashriya as input");
+    NEXT();
+}
+input_b: {
+    const std::string& word = input.word();
+    if (word.empty()) FAIL("input ended");
+    int64_t value = 0;
+    if (word == "True") value = 1;
+    else if (word != "False" && std::from_chars(word.data(), word.data() + word.size(), value).ptr != word.data() + word.size())
+        FAIL("expected True, False or a number as input");
+    A.i = value != 0;
+    NEXT();
+}
+input_c: {
+    int character = input.character();
+    if (character < 0) FAIL("input ended");
+    A.i = character;
+    NEXT();
+}
+
+#undef A
+#undef B
+#undef C
+#undef NEXT
+#undef JUMP_TO
+#undef FAIL
+
+fail:
+    output.flush();
+    std::cerr << "[RUN ERROR] " << failure << " in '" << bytecode.functions[function].name << "'\n";
+    return EXIT_FAILURE;
+done:
+    output.flush();
+    return isDecimal(first.type) ? static_cast<int>(truncateToAdadi(result.f)) : static_cast<int>(result.i);
+}
+
+bool compileBytecode(const TAC& tac, const AST& tree, const TokenStream& tokens, const NAME_BINDINGS& names,
+                     const TABLE<LITERAL_TABLE_ENTRY>& literal_table, BYTECODE& bytecode, std::vector<std::string>& errors) {
+    return BYTECODE_COMPILER(tac, tree, tokens, names, literal_table, bytecode, errors).run();
+}
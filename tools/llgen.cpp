@@ -0,0 +1,516 @@
+/*
+ * llgen: builds the LL(1) parse table for the parser from doc/CFG.txt.
+ *
+ *   llgen <grammar> <header out> <source out>
+ *
+ * computes FIRST and FOLLOW sets, fills PARSE_TABLE[nonterminal][terminal] with the
+ * production to expand, and writes it out as C++. conflicts are reported on stderr
+ * and resolved in favour of the production listed first in the grammar.
+ *
+ * @name on a right-hand side is an action: it matches nothing, so it is invisible to
+ * FIRST and FOLLOW, and the parser runs it when it comes off the stack.
+ *
+ * %left and %right lines list binary operators one binding power level at a time, loosest
+ * first, as in yacc. they become BINDING_POWERS for the parser's precedence climbing.
+ */
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char* const EPSILON = "^";
+
+// enumerator suffixes for operator and punctuator terminals
+static const std::map<std::string, std::string> PUNCTUATOR_NAMES = {
+    {"(", "LPAREN"}, {")", "RPAREN"}, {"{", "LBRACE"}, {"}", "RBRACE"}, {"[", "LBRACKET"}, {"]", "RBRACKET"},
+    {"::", "TERMINATOR"}, {":=", "ASSIGN"}, {",", "COMMA"},
+    {"+", "PLUS"}, {"-", "MINUS"}, {"*", "STAR"}, {"/", "SLASH"}, {"%", "PERCENT"},
+    {"=", "EQUALS"}, {"==", "EQ"}, {"!=", "NE"}, {"<", "LT"}, {">", "GT"}, {"<=", "LE"}, {">=", "GE"}, {"<>", "LTGT"},
+    {"&&", "AND"}, {"||", "OR"}, {"!", "NOT"}, {"+=", "PLUS_ASSIGN"}, {"++", "INCREMENT"},
+    {"<<", "SHIFT_LEFT"}, {">>", "SHIFT_RIGHT"},
+};
+
+// token classes the grammar may name directly
+static const std::map<std::string, std::string> TOKEN_CLASSES = {
+    {"identifier", "TK_IDENTIFIER"}, {"number", "TK_NUMBER"}, {"string", "TK_STRING"},
+};
+
+struct PRODUCTION {
+    int lhs;
+    std::vector<int> rhs;
+    int line;
+};
+
+struct GRAMMAR {
+    std::vector<std::string> terminals;     // in order of first use, then EOF and UNKNOWN
+    std::vector<std::string> nonterminals;  // in order of definition
+    std::vector<std::string> actions;       // in order of first use, without the '@'
+    std::vector<PRODUCTION> productions;
+    std::vector<std::vector<std::string>> levels;   // %left/%right operators, loosest first
+    std::vector<bool> right_associative;            // per level
+
+    int terminalCount() const { return terminals.size(); }
+    int firstAction() const { return terminals.size() + nonterminals.size(); }
+    int symbolCount() const { return firstAction() + actions.size(); }
+    bool isTerminal(int symbol) const { return symbol < terminalCount(); }
+    bool isAction(int symbol) const { return symbol >= firstAction(); }
+    const std::string& name(int symbol) const {
+        if (isTerminal(symbol)) return terminals[symbol];
+        if (isAction(symbol)) return actions[symbol - firstAction()];
+        return nonterminals[symbol - terminalCount()];
+    }
+};
+
+static bool isKeyword(const std::string& terminal) {
+    return isalpha(static_cast<unsigned char>(terminal[0])) && !TOKEN_CLASSES.count(terminal);
+}
+
+// keywords may end in punctuation (output<-, input->), which the enumerator leaves out
+static std::string upper(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\'') out += '_';
+        else if (isalnum(static_cast<unsigned char>(c))) out += toupper(static_cast<unsigned char>(c));
+    }
+    return out;
+}
+
+static std::string terminalEnumerator(const std::string& terminal) {
+    if (terminal == "$") return "TS_EOF";
+    if (terminal == "?") return "TS_UNKNOWN";
+    if (isKeyword(terminal) || TOKEN_CLASSES.count(terminal)) return "TS_" + upper(terminal);
+    return "TS_" + PUNCTUATOR_NAMES.at(terminal);
+}
+
+// Expr'' -> EXPR_2
+static std::string primeSuffix(const std::string& name, bool lower) {
+    size_t primes = name.find('\'');
+    std::string base = primes == std::string::npos ? name : name.substr(0, primes);
+    std::string out;
+    for (char c : base) out += lower ? c : toupper(static_cast<unsigned char>(c));
+    if (primes != std::string::npos) out += "_" + std::to_string(name.size() - primes);
+    return out;
+}
+
+static std::string nonterminalEnumerator(const std::string& nonterminal) {
+    return "NT_" + primeSuffix(nonterminal, false);
+}
+
+// @exprStmt -> AS_EXPR_STMT
+static std::string actionEnumerator(const std::string& action) {
+    std::string out = "AS_";
+    for (char c : action) {
+        if (isupper(static_cast<unsigned char>(c))) out += '_';
+        out += toupper(static_cast<unsigned char>(c));
+    }
+    return out;
+}
+
+static bool isActionName(const std::string& symbol) {
+    return symbol.size() > 1 && symbol[0] == '@';
+}
+
+// parse tree node name: TopLevel' -> topLevel_1
+static std::string nodeName(const std::string& nonterminal) {
+    std::string name = primeSuffix(nonterminal, true);
+    name[0] = tolower(static_cast<unsigned char>(name[0]));
+    return name;
+}
+
+static bool readGrammar(const char* filename, GRAMMAR& grammar) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "llgen: unable to open " << filename << "\n";
+        return false;
+    }
+
+    // first pass: every rule as lhs + alternatives of symbol names
+    struct RULE {
+        std::string lhs;
+        std::vector<std::vector<std::string>> alternatives;
+        int line;
+    };
+    std::vector<RULE> rules;
+    std::string text;
+    int line_number = 0;
+    while (std::getline(in, text)) {
+        ++line_number;
+        size_t comment = text.find('#');
+        if (comment != std::string::npos) text.erase(comment);
+
+        std::istringstream words(text);
+        std::vector<std::string> tokens;
+        for (std::string word; words >> word;) tokens.push_back(word);
+        if (tokens.empty()) continue;
+
+        if (tokens[0] == "%left" || tokens[0] == "%right") {
+            for (size_t i = 1; i < tokens.size(); ++i) {
+                if (!PUNCTUATOR_NAMES.count(tokens[i])) {
+                    std::cerr << filename << ":" << line_number << ": '" << tokens[i] << "' is not an operator\n";
+                    return false;
+                }
+            }
+            grammar.levels.emplace_back(tokens.begin() + 1, tokens.end());
+            grammar.right_associative.push_back(tokens[0] == "%right");
+            continue;
+        }
+
+        size_t start = 0;
+        if (tokens[0] == "|") {
+            // continuation of the previous rule
+            if (rules.empty()) {
+                std::cerr << filename << ":" << line_number << ": '|' before any rule\n";
+                return false;
+            }
+            rules.back().alternatives.emplace_back();
+            start = 1;
+        } else {
+            if (tokens.size() < 2 || tokens[1] != "->") {
+                std::cerr << filename << ":" << line_number << ": expected 'Name -> ...'\n";
+                return false;
+            }
+            rules.push_back({tokens[0], {{}}, line_number});
+            start = 2;
+        }
+        for (size_t i = start; i < tokens.size(); ++i) {
+            if (tokens[i] == "|") rules.back().alternatives.emplace_back();
+            else if (tokens[i] != EPSILON) rules.back().alternatives.back().push_back(tokens[i]);
+        }
+    }
+    if (rules.empty()) {
+        std::cerr << filename << ": no rules\n";
+        return false;
+    }
+
+    std::map<std::string, int> nonterminal_index;
+    for (const RULE& rule : rules) {
+        if (nonterminal_index.count(rule.lhs)) {
+            std::cerr << filename << ":" << rule.line << ": " << rule.lhs << " defined twice\n";
+            return false;
+        }
+        nonterminal_index[rule.lhs] = grammar.nonterminals.size();
+        grammar.nonterminals.push_back(rule.lhs);
+    }
+    std::map<std::string, int> terminal_index, action_index;
+    for (const RULE& rule : rules) {
+        for (const auto& alternative : rule.alternatives) {
+            for (const std::string& symbol : alternative) {
+                if (nonterminal_index.count(symbol) || terminal_index.count(symbol) || action_index.count(symbol)) continue;
+                if (isActionName(symbol)) {
+                    action_index[symbol] = grammar.actions.size();
+                    grammar.actions.push_back(symbol.substr(1));
+                    continue;
+                }
+                if (!isKeyword(symbol) && !TOKEN_CLASSES.count(symbol) && !PUNCTUATOR_NAMES.count(symbol)) {
+                    std::cerr << filename << ":" << rule.line << ": unknown terminal '" << symbol << "'\n";
+                    return false;
+                }
+                terminal_index[symbol] = grammar.terminals.size();
+                grammar.terminals.push_back(symbol);
+            }
+        }
+    }
+    // operators the parser only meets through BINDING_POWERS still need a terminal to be named by
+    for (const auto& level : grammar.levels) {
+        for (const std::string& op : level) {
+            if (terminal_index.count(op)) continue;
+            terminal_index[op] = grammar.terminals.size();
+            grammar.terminals.push_back(op);
+        }
+    }
+    grammar.terminals.push_back("$");
+    grammar.terminals.push_back("?");
+
+    int terminals = grammar.terminalCount();
+    for (const RULE& rule : rules) {
+        for (const auto& alternative : rule.alternatives) {
+            PRODUCTION production{terminals + nonterminal_index[rule.lhs], {}, rule.line};
+            for (const std::string& symbol : alternative) {
+                if (nonterminal_index.count(symbol)) production.rhs.push_back(terminals + nonterminal_index[symbol]);
+                else if (action_index.count(symbol)) production.rhs.push_back(grammar.firstAction() + action_index[symbol]);
+                else production.rhs.push_back(terminal_index[symbol]);
+            }
+            grammar.productions.push_back(production);
+        }
+    }
+    return true;
+}
+
+/*FIRST and FOLLOW as one bitset per symbol; bit terminalCount() stands for the empty string*/
+typedef std::vector<std::vector<bool>> SETS;
+
+static SETS computeFirst(const GRAMMAR& grammar) {
+    int empty = grammar.terminalCount();
+    SETS first(grammar.symbolCount(), std::vector<bool>(empty + 1, false));
+    for (int t = 0; t < grammar.terminalCount(); ++t) first[t][t] = true;
+    for (int a = grammar.firstAction(); a < grammar.symbolCount(); ++a) first[a][empty] = true;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const PRODUCTION& p : grammar.productions) {
+            bool all_empty = true;
+            for (int symbol : p.rhs) {
+                for (int t = 0; t < empty; ++t) {
+                    if (first[symbol][t] && !first[p.lhs][t]) first[p.lhs][t] = changed = true;
+                }
+                if (!first[symbol][empty]) {
+                    all_empty = false;
+                    break;
+                }
+            }
+            if (all_empty && !first[p.lhs][empty]) first[p.lhs][empty] = changed = true;
+        }
+    }
+    return first;
+}
+
+// FIRST of rhs[from..], with the empty bit set when all of it can vanish
+static std::vector<bool> firstOfSequence(const GRAMMAR& grammar, const SETS& first, const std::vector<int>& rhs, size_t from) {
+    int empty = grammar.terminalCount();
+    std::vector<bool> result(empty + 1, false);
+    for (size_t i = from; i < rhs.size(); ++i) {
+        for (int t = 0; t < empty; ++t) {
+            if (first[rhs[i]][t]) result[t] = true;
+        }
+        if (!first[rhs[i]][empty]) return result;
+    }
+    result[empty] = true;
+    return result;
+}
+
+static SETS computeFollow(const GRAMMAR& grammar, const SETS& first) {
+    int empty = grammar.terminalCount();
+    SETS follow(grammar.symbolCount(), std::vector<bool>(empty, false));
+    follow[grammar.terminalCount()][grammar.terminalCount() - 2] = true;    // $ follows the start symbol
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const PRODUCTION& p : grammar.productions) {
+            for (size_t i = 0; i < p.rhs.size(); ++i) {
+                int symbol = p.rhs[i];
+                if (grammar.isTerminal(symbol) || grammar.isAction(symbol)) continue;
+                std::vector<bool> rest = firstOfSequence(grammar, first, p.rhs, i + 1);
+                for (int t = 0; t < empty; ++t) {
+                    bool add = rest[t] || (rest[empty] && follow[p.lhs][t]);
+                    if (add && !follow[symbol][t]) follow[symbol][t] = changed = true;
+                }
+            }
+        }
+    }
+    return follow;
+}
+
+static std::string productionText(const GRAMMAR& grammar, const PRODUCTION& p) {
+    std::string text = grammar.name(p.lhs) + " ->";
+    if (p.rhs.empty()) text += " ^";
+    for (int symbol : p.rhs) text += (grammar.isAction(symbol) ? " @" : " ") + grammar.name(symbol);
+    return text;
+}
+
+static const int NO_PRODUCTION = 0xFF;
+
+static std::vector<std::vector<int>> buildTable(const GRAMMAR& grammar, const SETS& first, const SETS& follow, int& conflicts) {
+    int terminals = grammar.terminalCount();
+    std::vector<std::vector<int>> table(grammar.nonterminals.size(), std::vector<int>(terminals, NO_PRODUCTION));
+    conflicts = 0;
+
+    for (size_t index = 0; index < grammar.productions.size(); ++index) {
+        const PRODUCTION& p = grammar.productions[index];
+        std::vector<bool> predict = firstOfSequence(grammar, first, p.rhs, 0);
+        if (predict[terminals]) {
+            for (int t = 0; t < terminals; ++t) {
+                if (follow[p.lhs][t]) predict[t] = true;
+            }
+        }
+        for (int t = 0; t < terminals; ++t) {
+            if (!predict[t]) continue;
+            int& entry = table[p.lhs - terminals][t];
+            if (entry == NO_PRODUCTION) {
+                entry = index;
+            } else {
+                ++conflicts;
+                std::cerr << "llgen: LL(1) conflict in " << grammar.name(p.lhs) << " on '" << grammar.terminals[t]
+                          << "': keeping '" << productionText(grammar, grammar.productions[entry])
+                          << "' over '" << productionText(grammar, p) << "'\n";
+            }
+        }
+    }
+    return table;
+}
+
+static std::string symbolEnumerator(const GRAMMAR& grammar, int symbol) {
+    if (grammar.isTerminal(symbol)) return terminalEnumerator(grammar.terminals[symbol]);
+    if (grammar.isAction(symbol)) return actionEnumerator(grammar.name(symbol));
+    return nonterminalEnumerator(grammar.name(symbol));
+}
+
+static unsigned long rightAssociativeMask(const GRAMMAR& grammar) {
+    unsigned long mask = 0;
+    for (size_t level = 0; level < grammar.right_associative.size(); ++level) {
+        if (grammar.right_associative[level]) mask |= 1ul << level;
+    }
+    return mask;
+}
+
+static void writeHeader(std::ostream& out, const GRAMMAR& grammar) {
+    out << "// generated by tools/llgen from doc/CFG.txt, do not edit\n"
+           "#pragma once\n\n"
+           "#include <array>\n"
+           "#include <cstdint>\n"
+           "#include \"keyword.hpp\"\n\n"
+           "/*terminals first, then nonterminals, then actions; PARSE_TABLE is indexed by the first two*/\n"
+           "enum GRAMMAR_SYMBOL : uint8_t {\n";
+    for (int symbol = 0; symbol < grammar.symbolCount(); ++symbol) {
+        out << "    " << symbolEnumerator(grammar, symbol) << ",\n";
+    }
+    out << "    GRAMMAR_SYMBOL_COUNT\n"
+           "};\n\n"
+           "constexpr int TERMINAL_COUNT = TS_UNKNOWN + 1;\n"
+           "constexpr int FIRST_ACTION = " << grammar.firstAction() << ";\n"
+           "constexpr int NONTERMINAL_COUNT = FIRST_ACTION - TERMINAL_COUNT;\n"
+           "constexpr GRAMMAR_SYMBOL START_SYMBOL = " << symbolEnumerator(grammar, grammar.terminalCount()) << ";\n"
+           "constexpr uint8_t NO_PRODUCTION = 0xFF;\n\n"
+           "struct PRODUCTION {\n"
+           "    GRAMMAR_SYMBOL lhs;\n"
+           "    uint8_t length;\n"
+           "    uint16_t first;     // index of the first right-hand side symbol in PRODUCTION_SYMBOLS\n"
+           "};\n\n"
+           "extern const PRODUCTION PRODUCTIONS[];\n"
+           "extern const GRAMMAR_SYMBOL PRODUCTION_SYMBOLS[];\n"
+           "extern const uint8_t PARSE_TABLE[NONTERMINAL_COUNT][TERMINAL_COUNT];\n"
+           "// spelling of each terminal, parse tree node name of each nonterminal, @name of each action\n"
+           "extern const char* const GRAMMAR_SYMBOL_NAMES[GRAMMAR_SYMBOL_COUNT];\n"
+           "// terminal each token kind is matched as; TS_UNKNOWN for kinds the grammar never uses\n"
+           "extern const std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> KIND_TERMINALS;\n"
+           "// binding power of each binary operator from the %left/%right levels, loosest 1; 0 for other kinds\n"
+           "extern const std::array<uint8_t, TOKEN_KIND_COUNT> BINDING_POWERS;\n"
+           "constexpr uint8_t BINDING_POWER_LEVELS = " << grammar.levels.size() << ";\n\n"
+           "inline bool isTerminal(GRAMMAR_SYMBOL symbol) {\n"
+           "    return symbol < TERMINAL_COUNT;\n"
+           "}\n\n"
+           "inline bool isAction(GRAMMAR_SYMBOL symbol) {\n"
+           "    return symbol >= FIRST_ACTION;\n"
+           "}\n\n"
+           "inline GRAMMAR_SYMBOL terminalOf(TOKEN_KIND kind) {\n"
+           "    return KIND_TERMINALS[kind];\n"
+           "}\n\n"
+           "inline bool isRightAssociative(uint8_t power) {\n"
+           "    return power > 0 && (" << rightAssociativeMask(grammar) << "u >> (power - 1) & 1u);\n"
+           "}\n";
+}
+
+static void writeSource(std::ostream& out, const GRAMMAR& grammar, const std::vector<std::vector<int>>& table) {
+    out << "// generated by tools/llgen from doc/CFG.txt, do not edit\n"
+           "#include \"parse_table.hpp\"\n"
+           "#include <array>\n\n";
+
+    out << "const GRAMMAR_SYMBOL PRODUCTION_SYMBOLS[] = {\n";
+    size_t offset = 0;
+    std::vector<size_t> offsets;
+    for (const PRODUCTION& p : grammar.productions) {
+        offsets.push_back(offset);
+        out << "    /* " << productionText(grammar, p) << " */";
+        for (int symbol : p.rhs) out << " " << symbolEnumerator(grammar, symbol) << ",";
+        out << "\n";
+        offset += p.rhs.size();
+    }
+    if (offset == 0) out << "    TS_UNKNOWN,\n";
+    out << "};\n\n";
+
+    out << "const PRODUCTION PRODUCTIONS[] = {\n";
+    for (size_t i = 0; i < grammar.productions.size(); ++i) {
+        const PRODUCTION& p = grammar.productions[i];
+        out << "    {" << symbolEnumerator(grammar, p.lhs) << ", " << p.rhs.size() << ", " << offsets[i] << "},\n";
+    }
+    out << "};\n\n";
+
+    out << "const uint8_t PARSE_TABLE[NONTERMINAL_COUNT][TERMINAL_COUNT] = {\n";
+    out << "    //";
+    for (const std::string& t : grammar.terminals) out << " " << t;
+    out << "\n";
+    for (size_t nt = 0; nt < table.size(); ++nt) {
+        out << "    /* " << grammar.nonterminals[nt] << " */ {";
+        for (size_t t = 0; t < table[nt].size(); ++t) {
+            out << (t ? ", " : "") << table[nt][t];
+        }
+        out << "},\n";
+    }
+    out << "};\n\n";
+
+    out << "const char* const GRAMMAR_SYMBOL_NAMES[GRAMMAR_SYMBOL_COUNT] = {\n";
+    for (int symbol = 0; symbol < grammar.symbolCount(); ++symbol) {
+        std::string name = grammar.isTerminal(symbol) ? grammar.terminals[symbol]
+                         : grammar.isAction(symbol) ? "@" + grammar.name(symbol)
+                         : nodeName(grammar.name(symbol));
+        out << "    \"" << name << "\",\n";
+    }
+    out << "};\n\n";
+
+    // filled in at compile time from the lexer's own keyword hash and operator table
+    out << "static constexpr std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> buildKindTerminals() {\n"
+           "    std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> terminals{};\n"
+           "    for (auto& terminal : terminals) terminal = TS_UNKNOWN;\n";
+    std::string checks;
+    for (const std::string& t : grammar.terminals) {
+        std::string kind;
+        if (t == "$") kind = "TK_EOF";
+        else if (t == "?") continue;
+        else if (TOKEN_CLASSES.count(t)) kind = TOKEN_CLASSES.at(t);
+        else if (isKeyword(t)) kind = "lookupKeyword(\"" + t + "\")";
+        else kind = "operatorKind(\"" + t + "\")";
+        out << "    terminals[" << kind << "] = " << terminalEnumerator(t) << ";\n";
+        if (kind.find('(') != std::string::npos) {
+            checks += "static_assert(" + kind + " != TK_NONE, \"grammar terminal " + t + " has no token kind\");\n";
+        }
+    }
+    out << "    return terminals;\n"
+           "}\n\n"
+        << checks
+        << "\nconst std::array<GRAMMAR_SYMBOL, TOKEN_KIND_COUNT> KIND_TERMINALS = buildKindTerminals();\n\n";
+
+    out << "static constexpr std::array<uint8_t, TOKEN_KIND_COUNT> buildBindingPowers() {\n"
+           "    std::array<uint8_t, TOKEN_KIND_COUNT> powers{};\n";
+    for (size_t level = 0; level < grammar.levels.size(); ++level) {
+        for (const std::string& op : grammar.levels[level]) {
+            out << "    powers[operatorKind(\"" << op << "\")] = " << level + 1 << ";\n";
+        }
+    }
+    out << "    return powers;\n"
+           "}\n\n"
+           "const std::array<uint8_t, TOKEN_KIND_COUNT> BINDING_POWERS = buildBindingPowers();\n";
+}
+
+int main(int argc, char* args[]) {
+    if (argc != 4) {
+        std::cerr << "usage: llgen <grammar> <header out> <source out>\n";
+        return 1;
+    }
+
+    GRAMMAR grammar;
+    if (!readGrammar(args[1], grammar)) return 1;
+    if (grammar.productions.size() >= NO_PRODUCTION || grammar.symbolCount() > 0xFF || grammar.levels.size() > 31) {
+        std::cerr << "llgen: grammar too large for 8-bit table entries\n";
+        return 1;
+    }
+
+    SETS first = computeFirst(grammar);
+    SETS follow = computeFollow(grammar, first);
+    int conflicts = 0;
+    std::vector<std::vector<int>> table = buildTable(grammar, first, follow, conflicts);
+
+    std::ofstream header(args[2]), source(args[3]);
+    if (!header || !source) {
+        std::cerr << "llgen: unable to open output files\n";
+        return 1;
+    }
+    writeHeader(header, grammar);
+    writeSource(source, grammar, table);
+
+    std::cerr << "llgen: " << grammar.nonterminals.size() << " nonterminals, " << grammar.terminalCount() << " terminals, "
+              << grammar.actions.size() << " actions, " << grammar.levels.size() << " binding power levels, "
+              << grammar.productions.size() << " productions, " << conflicts << " conflicts resolved\n";
+    return 0;
+}